@@ -6,8 +6,16 @@ layout (location = 1) in vec2 aTexCoords;
 out vec2 fragTexCoords;
 
 uniform vec3 u_position;
-uniform mat4 u_projection;
-uniform mat4 u_view;
+
+layout (std140) uniform FrameData
+{
+	mat4 u_projection;
+	mat4 u_view;
+	vec3 u_lightDir;
+	float u_cascadePlaneDistances[16];
+	float u_farPlane;
+	int u_cascadeCount;
+};
 
 void main()
 {
@@ -6,8 +6,15 @@ out vec3 frag_texCoords;
 out vec4 frag_eyeCoords;
 out float frag_ambientLight;
 
-uniform mat4 u_projection;
-uniform mat4 u_view;
+layout (std140) uniform FrameData
+{
+	mat4 u_projection;
+	mat4 u_view;
+	vec3 u_lightDir;
+	float u_cascadePlaneDistances[16];
+	float u_farPlane;
+	int u_cascadeCount;
+};
 
 uniform vec3 u_chunkPos;
 
@@ -27,7 +34,7 @@ void main()
 	uint coordInd	= (aData >> 19) & 0x3;
 	uint texId		= (aData >> 21) & 0xF;
 
-	float ambient	= ((aData >> 25) & 0xF) / 10.0f;
+	float ambient	= ((aData >> 25) & 0x3) / 10.0f;
 
 	vec4 pos		= vec4(vec3(x, y, z) + u_chunkPos, 1.0f);
 	gl_Position		= u_projection * u_view * pos;
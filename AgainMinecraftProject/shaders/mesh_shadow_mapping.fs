@@ -6,6 +6,8 @@ in VS_OUT {
 	vec3 texCoords;
 	vec4 fragPosEyeSpace;
 	mat4 view;
+	float blockLight;
+	float skyLight;
 } frag_in;
 
 out vec4 o_fragColor;
@@ -13,21 +15,27 @@ out vec4 o_fragColor;
 uniform sampler2DArray u_textureArray;
 uniform sampler2DArray u_shadowMap;
 
-uniform vec3 u_lightDir;
-uniform float u_farPlane;
+layout (std140) uniform FrameData
+{
+	mat4 u_projection;
+	mat4 u_view;
+	vec3 u_lightDir;
+	float u_cascadePlaneDistances[16];
+	float u_farPlane;
+	int u_cascadeCount;
+};
 
 layout (std140) uniform LightSpaceMatrices
 {
     mat4 u_lightSpaceMatrices[16];
 };
 
-uniform float u_cascadePlaneDistances[16];
-uniform int u_cascadeCount;
 uniform bool u_showCascades;
 
 float g_near = 180.0f;
 float g_far = 200.0f;
 vec4 g_fogColor = vec4(147.0f/255.0f, 202.0f/255.0f, 237.0f/255.0f, 1.0f);
+vec3 g_blockLightColor = vec3(1.0f, 0.85f, 0.6f);
 
 const vec3 g_debugColors[5] = {
     vec3(0.0f, 1.0f, 0.0f),
@@ -55,8 +63,11 @@ void main()
 
     float shadow = calculateShadow(frag_in.fragPosWorld);
 
+    // Block light isn't shadowed, squared so it fades out faster than the levels drop
+    vec3 blockLight = 1.2f * frag_in.blockLight * frag_in.blockLight * g_blockLightColor * textureWithLight.rgb;
+
     textureWithLight = 
-        vec4((ambient + (1.0f - shadow) * diffuse) * textureWithLight.rgb, textureWithLight.a);
+        vec4((ambient + (1.0f - shadow) * diffuse + blockLight) * textureWithLight.rgb, textureWithLight.a);
 
     if (u_showCascades)
     {
@@ -82,9 +93,10 @@ float calculateShadow(vec3 fragPosWorldSpace)
             break;
         }
     }
+    // Far terrain has no cascade, it's in the shade when anything is above it
     if (layer == -1)
     {
-        layer = u_cascadeCount;
+        return 1.0f - frag_in.skyLight;
     }
 
     vec4 fragPosLightSpace = u_lightSpaceMatrices[layer] * vec4(fragPosWorldSpace, 1.0f);
@@ -103,14 +115,7 @@ float calculateShadow(vec3 fragPosWorldSpace)
     //vec3 lightDir = normalize(-u_lightDir);
     float bias = max(0.05f * (1.0f - dot(normal, u_lightDir)), 0.03f);
     const float biasModifier = 0.5f;
-    if (layer == u_cascadeCount)
-    {
-        bias *= 1 / (u_farPlane * biasModifier);
-    }
-    else
-    {
-        bias *= 1 / (u_cascadePlaneDistances[layer] * biasModifier);
-    }
+    bias *= 1 / (u_cascadePlaneDistances[layer] * biasModifier);
     // check whether current frag pos is in shadow
     // float shadow = currentDepth - bias > closestDepth  ? 1.0 : 0.0;
     // PCF
@@ -2,8 +2,16 @@
 
 layout (location = 0) in uint aData;
 
-uniform mat4 u_projection;
-uniform mat4 u_view;
+layout (std140) uniform FrameData
+{
+	mat4 u_projection;
+	mat4 u_view;
+	vec3 u_lightDir;
+	float u_cascadePlaneDistances[16];
+	float u_farPlane;
+	int u_cascadeCount;
+};
+
 uniform vec3 u_chunkPos;
 
 out VS_OUT {
@@ -12,6 +20,8 @@ out VS_OUT {
 	vec3 texCoords;
 	vec4 fragPosEyeSpace;
 	mat4 view;
+	float blockLight;
+	float skyLight;
 } frag_in;
 
 const vec2 g_texCoords[4] = vec2[4](
@@ -41,6 +51,8 @@ void main()
 	uint coordInd	= (aData >> 19) & 0x3;
 	uint texId		= (aData >> 21) & 0xF;
 	uint normalId	= (aData >> 25) & 0x3;
+	uint skyLit		= (aData >> 27) & 0x1;
+	uint light		= (aData >> 28) & 0xF;
 
 	vec4 pos		= vec4(coords, 1.0f);
 	gl_Position		= u_projection * u_view * pos;
@@ -50,4 +62,6 @@ void main()
 	frag_in.texCoords			= vec3(g_texCoords[coordInd], texId);
 	frag_in.normal				= transpose(inverse(mat3(1.0f))) * (g_normals[normalId]);
 	frag_in.view				= u_view;
+	frag_in.blockLight			= float(light) / 15.0f;
+	frag_in.skyLight			= float(skyLit);
 }
@@ -0,0 +1,9 @@
+#version 410 core
+out vec4 FragColor;
+
+uniform vec3 u_color;
+
+void main()
+{
+    FragColor = vec4(u_color, 1.0f);
+}
@@ -0,0 +1,7 @@
+#version 410 core
+layout (location = 0) in vec2 aPos;
+
+void main()
+{
+    gl_Position = vec4(aPos, 0.0f, 1.0f);
+}
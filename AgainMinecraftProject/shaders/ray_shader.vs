@@ -2,8 +2,15 @@
 
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 u_projection;
-uniform mat4 u_view;
+layout (std140) uniform FrameData
+{
+	mat4 u_projection;
+	mat4 u_view;
+	vec3 u_lightDir;
+	float u_cascadePlaneDistances[16];
+	float u_farPlane;
+	int u_cascadeCount;
+};
 
 void main()
 {
@@ -0,0 +1,22 @@
+#version 410 core
+
+layout (location = 0) in uint aData;
+
+layout (std140) uniform LightSpaceMatrices
+{
+    mat4 u_lightSpaceMatrices[16];
+};
+
+uniform vec3 u_chunkPos;
+uniform int u_layer;
+
+void main()
+{
+	vec3 pos = u_chunkPos + vec3(
+		aData & 0x1F,			// x
+		(aData >> 5) & 0x1FF,	// y
+		(aData >> 14) & 0x1F	// z
+	);
+
+    gl_Position = u_lightSpaceMatrices[u_layer] * vec4(pos, 1.0);
+}
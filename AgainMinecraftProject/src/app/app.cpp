@@ -1,10 +1,16 @@
 #include <glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <chrono>
 #include <functional>
+#include <future>
 #include <mutex>
 #include <thread>
 #include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
 
 #include "../engine/window/window.h"
 #include "../engine/shader/shader_list.h"
@@ -13,6 +19,10 @@
 
 #include "../engine/ray/ray.h"
 #include "../engine/renderer/block_renderer.h"
+#include "../engine/profiler/profiler.h"
+#include "../engine/profiler/profiler_overlay.h"
+#include "../engine/memory/alloc_counter.h"
+#include "../engine/jobs/jobs.h"
 
 #include "../modules/chunk/block.h"
 
@@ -40,8 +50,27 @@ constexpr float g_playerAcceleration = 30.0f;
 constexpr float g_gravity = 0.9f;
 constexpr float g_jumpForce = 12.0f;
 
+// Velocity left after 1/60 of a second, scaled to the tick length
+constexpr float g_velocityDamping = 0.95f;
+constexpr float g_dampingTime = 1.0f / 60.0f;
+
+// Slow frames run at most that many ticks, the rest of the backlog is dropped
+constexpr uint32_t g_maxTicksPerFrame = 5;
+
 constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
 
+constexpr float g_titleUpdateTime = 1.0f;
+const char* g_profilePath = "profile.txt";
+const char* g_tracePath = "trace.json";
+const char* g_textureCachePath = "textures/textures.cache";
+
+constexpr float g_megabyte = 1024.0f * 1024.0f;
+
+// Loading is over by then, later frames shouldn't touch the heap
+constexpr uint32_t g_warmupFrames = 120;
+
+bool g_showProfiler = false;
+
 #ifdef _DEBUG
 bool g_showCascades = false;
 int32_t g_layer = 0;
@@ -65,14 +94,36 @@ Application::~Application()
 
 void Application::init()
 {
+	setTraceThreadName("main");
+
 	m_window = getWindow(g_title, g_width, g_height);
+	enableGpuProfiling();
+
+	// The main and the simulation thread keep a core each
+	const uint32_t cores = std::thread::hardware_concurrency();
+	initJobs(cores > 2 ? cores - 2 : 0);
 
 	initPlayer();
 
 	initShaders();
-	initTextures();
+
+	// Images decode on a worker while the world generates
+	TextureArrayData textureData;
+	std::future<bool> textures = std::async(std::launch::async, [&textureData]() {
+		setTraceThreadName("textureLoader");
+		return loadTextureArrayData(textureData, s_tPaths, g_textureCachePath);
+	});
 
 	initWorld(m_world, m_player);
+
+	// Stands on top of its column instead of at a fixed height
+	m_player.pos.y = static_cast<float>(getSurfaceHeight(m_world,
+		static_cast<int32_t>(m_player.pos.x), static_cast<int32_t>(m_player.pos.z)));
+	m_player.camera.pos.y = m_player.pos.y + m_player.height - 0.2f;
+
+	textures.get();
+	initTextures(textureData);
+	releaseTextureArrayData(textureData);
 }
 
 void Application::initPlayer()
@@ -117,6 +168,7 @@ void Application::initShaders()
 	Engine::Renderer::loadCubeData();
 	Engine::Renderer::loadPlayerOutlineData();
 	Engine::Renderer::loadQuadData();
+	initProfilerOverlay();
 
 	Engine::loadShaders(m_shaders);
 
@@ -128,54 +180,199 @@ void Application::initShaders()
 
 	m_player.camera.projection = projection;
 
-	useShader(m_shaders[ShadersAvailable::s_cubeShader]);
-	setUniform4m(m_shaders[ShadersAvailable::s_cubeShader], "u_projection", projection);
-	setUniform4m(m_shaders[ShadersAvailable::s_cubeShader], "u_view", m_player.camera.view);
+	// Projection and view come from the FrameData uniform block,
+	// samplers only need their units set once
+	setUniform3f(m_shaders[ShadersAvailable::s_lightObj], Uniform::POSITION, m_world.lightDir);
 
-	useShader(m_shaders[ShadersAvailable::s_meshAndShadow]);
-	setUniform4m(m_shaders[ShadersAvailable::s_meshAndShadow], "u_projection", projection);
-	setUniform4m(m_shaders[ShadersAvailable::s_meshAndShadow], "u_view", m_player.camera.view);
+	setUniformi(m_shaders[ShadersAvailable::s_meshAndShadow], Uniform::TEXTURE_ARRAY, 0);
+	setUniformi(m_shaders[ShadersAvailable::s_meshAndShadow], Uniform::SHADOW_MAP, 1);
+	setUniformi(m_shaders[ShadersAvailable::s_debugQuad], Uniform::DEPTH_MAP, 1);
+}
 
-	useShader(m_shaders[ShadersAvailable::s_lightObj]);
-	setUniform4m(m_shaders[ShadersAvailable::s_lightObj], "u_projection", projection);
-	setUniform3f(m_shaders[ShadersAvailable::s_lightObj], "u_position", m_world.lightDir);
-	setUniform4m(m_shaders[ShadersAvailable::s_lightObj], "u_view", m_player.camera.view);
+void Application::initTextures(const TextureArrayData& data)
+{
+	PROFILE_SCOPE("initTextures");
 
-	useShader(m_shaders[ShadersAvailable::s_rayShader]);
-	setUniform4m(m_shaders[ShadersAvailable::s_rayShader], "u_projection", projection);
-	setUniform4m(m_shaders[ShadersAvailable::s_rayShader], "u_view", m_player.camera.view);
+	initTextureArray(m_tArray, data);
+}
 
-	useShader(m_shaders[ShadersAvailable::s_outlineShader]);
-	setUniform4m(m_shaders[ShadersAvailable::s_outlineShader], "u_projection", projection);
-	setUniform4m(m_shaders[ShadersAvailable::s_outlineShader], "u_view", m_player.camera.view);
+// Steps the simulation by a fixed tick and publishes a snapshot after every tick
+void Application::simulate()
+{
+	using Clock = std::chrono::steady_clock;
+
+	setTraceThreadName("simulation");
+
+	const Clock::duration tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(m_tickTime));
+	Clock::time_point nextTick = Clock::now() + tick;
+	while (m_isRunning)
+	{
+		std::this_thread::sleep_until(nextTick);
+
+		uint32_t ticks = 0;
+		for (; Clock::now() >= nextTick && ticks < g_maxTicksPerFrame; ticks++)
+		{
+			SimInput input;
+			{
+				std::lock_guard<std::mutex> lock(m_snapshotMutex);
+				input = m_input;
+				applySolidityChanges(m_world, m_solidityChanges);
+			}
+
+			const glm::vec3 previousCameraPos = m_player.camera.pos;
+			onUpdate(m_tickTime, input);
+			publishSnapshot(previousCameraPos);
+
+			nextTick += tick;
+		}
+
+		// Too far behind, the backlog is dropped
+		if (ticks == g_maxTicksPerFrame && Clock::now() >= nextTick)
+		{
+			nextTick = Clock::now() + tick;
+		}
+	}
 }
 
-void Application::initTextures()
+void Application::publishSnapshot(const glm::vec3& previousCameraPos)
 {
-	initTextureArray(m_tArray, s_tPaths);
+	std::lock_guard<std::mutex> lock(m_snapshotMutex);
+
+	m_snapshot.tick++;
+	m_snapshot.time = glfwGetTime();
+	m_snapshot.playerPos = m_player.pos;
+	m_snapshot.cameraPos = m_player.camera.pos;
+	m_snapshot.previousCameraPos = previousCameraPos;
+
+	// Changes pile up until the render thread takes them, a removal cancels a pending add
+	WorldChanges& changes = m_snapshot.changes;
+	for (const glm::ivec3& pos : m_simChanges.removed)
+	{
+		changes.added.erase(std::remove_if(changes.added.begin(), changes.added.end(),
+			[&pos](const Chunk& chunk) { return glm::ivec3(chunk.pos) == pos; }), changes.added.end());
+		changes.removed.push_back(pos);
+	}
+
+	for (Chunk& chunk : m_simChanges.added)
+	{
+		changes.added.push_back(std::move(chunk));
+	}
+
+	m_simChanges.added.clear();
+	m_simChanges.removed.clear();
+}
+
+void Application::takeSnapshot()
+{
+	std::lock_guard<std::mutex> lock(m_snapshotMutex);
+
+	m_input.forward = m_keyboard[GLFW_KEY_W];
+	m_input.back = m_keyboard[GLFW_KEY_S];
+	m_input.left = m_keyboard[GLFW_KEY_A];
+	m_input.right = m_keyboard[GLFW_KEY_D];
+	m_input.jump = m_keyboard[GLFW_KEY_SPACE];
+	m_input.front = m_renderPlayer.camera.front;
+	collectSolidityChanges(m_world, m_solidityChanges);
+
+	// Swapped, so both sides keep the capacity of their vectors
+	std::swap(m_renderSnapshot.changes, m_snapshot.changes);
+	m_renderSnapshot.tick = m_snapshot.tick;
+	m_renderSnapshot.time = m_snapshot.time;
+	m_renderSnapshot.playerPos = m_snapshot.playerPos;
+	m_renderSnapshot.cameraPos = m_snapshot.cameraPos;
+	m_renderSnapshot.previousCameraPos = m_snapshot.previousCameraPos;
 }
 
 void Application::run()
 {
-	static float limits = 1.0f / 60.0f;
-	float previousFrame = (float)glfwGetTime();
+	double previousFrame = glfwGetTime();
+	float titleTime = 0.0f;
+#ifdef TRACK_ALLOCATIONS
+	uint32_t frame = 0;
+#endif
+	uint64_t renderedTick = 0;
+	std::array<char, 1280> title;
+
+	m_renderPlayer = m_player;
+	m_snapshot.time = previousFrame;
+	m_snapshot.playerPos = m_player.pos;
+	m_snapshot.cameraPos = m_player.camera.pos;
+	m_snapshot.previousCameraPos = m_player.camera.pos;
+	m_simThread = std::thread(&Application::simulate, this);
+
 	while (m_isRunning)
 	{
-		float currentFrame = (float)glfwGetTime();
-		float dt = (currentFrame - previousFrame);
+		const uint64_t frameAllocations = getAllocationCount();
+		beginProfilerFrame();
+
+		const double currentFrame = glfwGetTime();
+		const float dt = static_cast<float>(currentFrame - previousFrame);
 		previousFrame = currentFrame;
 
-		onUpdate(dt);
-		clearScreen();
+		handleInput();
+		onInput();
+		takeSnapshot();
+
+		applyWorldChanges(m_world, m_renderSnapshot.changes);
+		updateFluids(m_world, dt);
+		settleColumns(m_world);
+		remeshEditedChunks(m_world);
+		setProfileCounter("ticks", m_renderSnapshot.tick - renderedTick, g_maxTicksPerFrame);
+		renderedTick = m_renderSnapshot.tick;
+
+		// Rendered between the last two ticks
+		const float alpha = glm::clamp(static_cast<float>((currentFrame - m_renderSnapshot.time) / m_tickTime), 0.0f, 1.0f);
+		m_renderPlayer.pos = m_renderSnapshot.playerPos;
+		m_renderPlayer.camera.pos = glm::mix(m_renderSnapshot.previousCameraPos, m_renderSnapshot.cameraPos, alpha);
+		updateCameraView(m_renderPlayer.camera);
 
+		clearScreen();
 		onRender();
 
-		handleInput();
 		updateScreen(m_window);
 
+		endProfilerFrame();
+
+		const uint64_t allocations = getAllocationCount() - frameAllocations;
+		setProfileCounter("allocs", allocations);
+#ifdef TRACK_ALLOCATIONS
+		if (++frame > g_warmupFrames && allocations)
+		{
+			std::cout << "WARNING::FRAME::HEAP_ALLOCATIONS::" << allocations << std::endl;
+		}
+#endif
+
+		titleTime += dt;
+		if (titleTime > g_titleUpdateTime)
+		{
+			const WorldMemory memory = getWorldMemory(m_world);
+			setProfileCounter("blocks MB", memory.blockBytes / g_megabyte);
+			setProfileCounter("meshes MB", (memory.meshBytes + memory.meshSlackBytes) / g_megabyte);
+			setProfileCounter("gpu MB", memory.gpuBytes / g_megabyte);
+			setProfileCounter("buffers", memory.activeBuffers, memory.poolSize);
+
+			std::snprintf(title.data(), title.size(), "%s | %s", g_title, getProfileSummary());
+			glfwSetWindowTitle(m_window, title.data());
+			titleTime = 0.0f;
+		}
+
+		m_isRunning = !glfwWindowShouldClose(m_window);
+	}
+
+	m_simThread.join();
+	shutdownJobs();
+
+	if (isTracing())
+	{
+		writeTrace(g_tracePath);
 	}
 }
 
+void Application::setTickRate(float ticksPerSecond)
+{
+	m_tickTime = 1.0f / ticksPerSecond;
+}
+
 void Application::handleInput()
 {
 	if (glfwGetKey(m_window, GLFW_KEY_W) == GLFW_PRESS)
@@ -245,6 +442,39 @@ void Application::handleInput()
 		m_keyboardPressed[GLFW_KEY_N] = false;
 	}
 
+	if (glfwGetKey(m_window, GLFW_KEY_P) == GLFW_PRESS &&
+		!m_keyboardPressed[GLFW_KEY_P])
+	{
+		m_keyboard[GLFW_KEY_P] = true;
+	}
+	else if (glfwGetKey(m_window, GLFW_KEY_P) == GLFW_RELEASE)
+	{
+		m_keyboard[GLFW_KEY_P] = false;
+		m_keyboardPressed[GLFW_KEY_P] = false;
+	}
+
+	if (glfwGetKey(m_window, GLFW_KEY_T) == GLFW_PRESS &&
+		!m_keyboardPressed[GLFW_KEY_T])
+	{
+		m_keyboard[GLFW_KEY_T] = true;
+	}
+	else if (glfwGetKey(m_window, GLFW_KEY_T) == GLFW_RELEASE)
+	{
+		m_keyboard[GLFW_KEY_T] = false;
+		m_keyboardPressed[GLFW_KEY_T] = false;
+	}
+
+	if (glfwGetKey(m_window, GLFW_KEY_O) == GLFW_PRESS &&
+		!m_keyboardPressed[GLFW_KEY_O])
+	{
+		m_keyboard[GLFW_KEY_O] = true;
+	}
+	else if (glfwGetKey(m_window, GLFW_KEY_O) == GLFW_RELEASE)
+	{
+		m_keyboard[GLFW_KEY_O] = false;
+		m_keyboardPressed[GLFW_KEY_O] = false;
+	}
+
 #ifdef _DEBUG
 	if (glfwGetKey(m_window, GLFW_KEY_R) == GLFW_PRESS &&
 		!m_keyboardPressed[GLFW_KEY_R])
@@ -284,50 +514,50 @@ void Application::handleInput()
 
 void Application::onRender()
 {
-	setUniform4m(m_shaders[ShadersAvailable::s_lightObj], "u_view", m_player.camera.view);
+	PROFILE_SCOPE("onRender");
+
+	Renderer::resetCommandStats(m_world.commands);
+	resetFrameArena(m_world.frameArena);
+	updateFrameData(m_world, m_renderPlayer);
 	//Renderer::render(Renderer::Type::CUBE);
 
-	setUniform4m(m_shaders[ShadersAvailable::s_outlineShader], "u_view", m_player.camera.view);
 	//Renderer::render(Renderer::Type::CUBE_LINES);
 
-	setUniform4m(m_shaders[ShadersAvailable::s_outlineShader], "u_view", m_player.camera.view);
-	setUniform3f(m_shaders[ShadersAvailable::s_outlineShader], "u_position", m_player.pos);
+	setUniform3f(m_shaders[ShadersAvailable::s_outlineShader], Uniform::POSITION, m_renderPlayer.pos);
 	//Renderer::render(Renderer::Type::PLAYER);
 
-	drawWorlToSM(m_world, m_player, m_shaders[ShadersAvailable::s_cascadedDepth]);
+	drawWorlToSM(m_world, m_renderPlayer, m_shaders[ShadersAvailable::s_cascadeLayerDepth]);
 	Engine::setViewport(g_width, g_height);
 	Engine::clearBuffers();
 
 #ifdef _DEBUG
 	if (g_debugShadow)
 	{
-		setUniformi(m_shaders[ShadersAvailable::s_debugQuad], "u_depthMap", 1);
-		setUniformi(m_shaders[ShadersAvailable::s_debugQuad], "u_layer", g_layer);
+		setUniformi(m_shaders[ShadersAvailable::s_debugQuad], Uniform::LAYER, g_layer);
 		drawDebugQuad(m_world, m_shaders[ShadersAvailable::s_debugQuad]);
 	}
 	else
 	{
-		setUniform4m(m_shaders[ShadersAvailable::s_meshAndShadow], "u_view", m_player.camera.view);
-		setUniformi(m_shaders[ShadersAvailable::s_meshAndShadow], "u_textureArray", 0);
 		useTextureArray(m_tArray);
-		setUniformi(m_shaders[ShadersAvailable::s_meshAndShadow], "u_shadowMap", 1);
-		setUniformBool(m_shaders[ShadersAvailable::s_meshAndShadow], "u_showCascades", g_showCascades);
-		drawWorld(m_world, m_player, m_shaders[ShadersAvailable::s_meshAndShadow]);
+		setUniformBool(m_shaders[ShadersAvailable::s_meshAndShadow], Uniform::SHOW_CASCADES, g_showCascades);
+		drawWorld(m_world, m_renderPlayer, m_shaders[ShadersAvailable::s_meshAndShadow]);
 	}
-	setUniform4m(m_shaders[ShadersAvailable::s_rayShader], "u_view", m_player.camera.view);
 	//Renderer::render(Renderer::Type::RAY);
 #else
-	setUniform4m(m_shaders[ShadersAvailable::s_meshAndShadow], "u_view", m_player.camera.view);
-	setUniformi(m_shaders[ShadersAvailable::s_meshAndShadow], "u_textureArray", 0);
-	setUniformi(m_shaders[ShadersAvailable::s_meshAndShadow], "u_shadowMap", 1);
 	useTextureArray(m_tArray);
-	drawWorld(m_world, m_player, m_shaders[ShadersAvailable::s_meshAndShadow]);
+	drawWorld(m_world, m_renderPlayer, m_shaders[ShadersAvailable::s_meshAndShadow]);
 #endif
+
+	if (g_showProfiler)
+	{
+		drawProfilerOverlay(m_shaders[ShadersAvailable::s_profilerGraph]);
+	}
 }
 
-void Application::onUpdate(float dt)
+// Runs on the main thread, anything touching GL or the overlay goes here
+void Application::onInput()
 {
-	Ray ray = castRay(m_player.camera);
+	Ray ray = castRay(m_renderPlayer.camera);
 	RayType type = RayType::IDLE;
 
 	// Ray handling
@@ -342,38 +572,32 @@ void Application::onUpdate(float dt)
 		m_keyboardPressed[GLFW_MOUSE_BUTTON_LEFT] = true;
 	}
 
-	static bool move = false;
-	// Player handling
-	glm::vec3 v = glm::normalize(
-		glm::vec3(m_player.camera.front.x, m_player.camera.front.y, m_player.camera.front.z));
-	if (m_keyboard[GLFW_KEY_W])
-	{
-		m_player.velocity += v * m_player.speed * dt;
-	}
-
-	if (m_keyboard[GLFW_KEY_S])
+	if (m_keyboard[GLFW_KEY_P] && !m_keyboardPressed[GLFW_KEY_P])
 	{
-		m_player.velocity += -v * m_player.speed * dt;
+		g_showProfiler = !g_showProfiler;
+		m_keyboardPressed[GLFW_KEY_P] = true;
 	}
 
-	if (m_keyboard[GLFW_KEY_A])
+	// Tracing session is written out once it gets stopped
+	if (m_keyboard[GLFW_KEY_T] && !m_keyboardPressed[GLFW_KEY_T])
 	{
-		auto left = glm::normalize(glm::cross(v, glm::vec3(0.0f, 1.0f, 0.0f)));
-		m_player.velocity += -left * m_player.speed * dt;
-	}
-
-	if (m_keyboard[GLFW_KEY_D])
-	{
-		auto right = glm::normalize(glm::cross(v, glm::vec3(0.0f, 1.0f, 0.0f)));
-		m_player.velocity += right * m_player.speed * dt;
+		if (isTracing())
+		{
+			enableTracing(false);
+			writeTrace(g_tracePath);
+		}
+		else
+		{
+			clearTrace();
+			enableTracing(true);
+		}
+		m_keyboardPressed[GLFW_KEY_T] = true;
 	}
 
-	// My shitty jumping
-	if (m_keyboard[GLFW_KEY_SPACE] && !m_player.isJumping)
+	if (m_keyboard[GLFW_KEY_O] && !m_keyboardPressed[GLFW_KEY_O])
 	{
-		m_player.isJumping = true;
-		m_player.jumpAcceleration = 1.5f;
-		m_player.heightJumped = 0.0f;
+		dumpProfile(g_profilePath);
+		m_keyboardPressed[GLFW_KEY_O] = true;
 	}
 
 #ifdef _DEBUG
@@ -395,6 +619,48 @@ void Application::onUpdate(float dt)
 
 	}
 #endif
+}
+
+// Runs on the simulation thread, only touches m_player and the streaming state of the world
+void Application::onUpdate(float dt, const SimInput& input)
+{
+	PROFILE_SCOPE("onUpdate");
+
+	m_player.camera.front = input.front;
+
+	static bool move = false;
+	// Player handling
+	glm::vec3 v = glm::normalize(
+		glm::vec3(m_player.camera.front.x, m_player.camera.front.y, m_player.camera.front.z));
+	if (input.forward)
+	{
+		m_player.velocity += v * m_player.speed * dt;
+	}
+
+	if (input.back)
+	{
+		m_player.velocity += -v * m_player.speed * dt;
+	}
+
+	if (input.left)
+	{
+		auto left = glm::normalize(glm::cross(v, glm::vec3(0.0f, 1.0f, 0.0f)));
+		m_player.velocity += -left * m_player.speed * dt;
+	}
+
+	if (input.right)
+	{
+		auto right = glm::normalize(glm::cross(v, glm::vec3(0.0f, 1.0f, 0.0f)));
+		m_player.velocity += right * m_player.speed * dt;
+	}
+
+	// My shitty jumping
+	if (input.jump && !m_player.isJumping)
+	{
+		m_player.isJumping = true;
+		m_player.jumpAcceleration = 1.5f;
+		m_player.heightJumped = 0.0f;
+	}
 
 	glm::vec3 up = glm::vec3(0.0f, 0.1f, 0.0f);
 	glm::vec3 down = glm::vec3(0.0f, -0.1f, 0.0f);
@@ -405,28 +671,26 @@ void Application::onUpdate(float dt)
 		m_player.jumpAcceleration -= g_gravity * down.y * dt;
 	}
 
-	//if (isPlayerFalling(m_world, m_player, dt))
+	//if (!isOnGround(m_world, { m_player.pos, m_player.pos + m_player.size }))
 	{
 		//	m_player.velocity += down * g_gravity * dt;
 	}
 	//else
 	{
-		if (!m_keyboard[GLFW_KEY_SPACE] && m_player.isJumping)
+		if (!input.jump && m_player.isJumping)
 		{
 			m_player.isJumping = false;
 		}
 	}
 
-	//checkPlayerCollision(m_world, m_player, dt);
-
-	m_player.camera.pos += m_player.velocity * dt;
-	m_player.pos += m_player.velocity * dt;
+	movePlayer(m_world, m_player, dt);
+	updateEntities(m_world, m_entities, dt);
 
 	//m_world.fractionPos += m_player.velocity * dt;
 	//m_world.pos = static_cast<glm::ivec3>(m_world.fractionPos) / 16 * 16;
-	m_player.velocity *= 0.95f;
+	m_player.velocity *= std::pow(g_velocityDamping, dt / g_dampingTime);
 
-	updateWorld(m_world, m_player, dt);
+	updateWorld(m_world, m_player, dt, m_simChanges);
 	updateCameraView(m_player.camera);
 	//processRay(m_world, m_player, ray, m_shaders[s_outlineShader], type);
 }
@@ -436,35 +700,35 @@ void Application::handleCamera(const double xPos, const double yPos)
 	static bool firstMove = true;
 	if (firstMove)
 	{
-		m_player.camera.lastX = xPos;
-		m_player.camera.lastY = yPos;
+		m_renderPlayer.camera.lastX = xPos;
+		m_renderPlayer.camera.lastY = yPos;
 		firstMove = false;
 	}
 
-	float xoffset = xPos - m_player.camera.lastX;
-	float yoffset = m_player.camera.lastY - yPos;
-	m_player.camera.lastX = xPos;
-	m_player.camera.lastY = yPos;
+	float xoffset = xPos - m_renderPlayer.camera.lastX;
+	float yoffset = m_renderPlayer.camera.lastY - yPos;
+	m_renderPlayer.camera.lastX = xPos;
+	m_renderPlayer.camera.lastY = yPos;
 
 	float sensitivity = 0.1f;
 	xoffset *= sensitivity;
 	yoffset *= sensitivity;
 
-	m_player.camera.yaw += xoffset;
-	m_player.camera.pitch += yoffset;
+	m_renderPlayer.camera.yaw += xoffset;
+	m_renderPlayer.camera.pitch += yoffset;
 
-	if (m_player.camera.pitch > 89.0f)
+	if (m_renderPlayer.camera.pitch > 89.0f)
 	{
-		m_player.camera.pitch = 89.0f;
+		m_renderPlayer.camera.pitch = 89.0f;
 	}
-	if (m_player.camera.pitch < -89.0f)
+	if (m_renderPlayer.camera.pitch < -89.0f)
 	{
-		m_player.camera.pitch = -89.0f;
+		m_renderPlayer.camera.pitch = -89.0f;
 	}
 
 	glm::vec3 direction;
-	direction.x = cos(glm::radians(m_player.camera.yaw)) * cos(glm::radians(m_player.camera.pitch));
-	direction.y = sin(glm::radians(m_player.camera.pitch));
-	direction.z = sin(glm::radians(m_player.camera.yaw)) * cos(glm::radians(m_player.camera.pitch));
-	m_player.camera.front = glm::normalize(direction);
+	direction.x = cos(glm::radians(m_renderPlayer.camera.yaw)) * cos(glm::radians(m_renderPlayer.camera.pitch));
+	direction.y = sin(glm::radians(m_renderPlayer.camera.pitch));
+	direction.z = sin(glm::radians(m_renderPlayer.camera.yaw)) * cos(glm::radians(m_renderPlayer.camera.pitch));
+	m_renderPlayer.camera.front = glm::normalize(direction);
 }
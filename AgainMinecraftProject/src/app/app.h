@@ -6,22 +6,44 @@
 #include "../engine/ray/ray.h"
 #include "../engine/renderer/block_renderer.h"
 
-#ifdef ECS
-#endif
-
 #include "../modules/player/player.h"
 #include "../modules/world/world.h"
+#include "../modules/entity/entity.h"
 
 #include <unordered_map>
 #include <map>
 #include <vector>
 #include <mutex>
 #include <thread>
+#include <atomic>
 
 struct GLFWwindow;
 
 namespace App
 {
+	// Sampled on the main thread for the simulation
+	struct SimInput
+	{
+		bool		forward = false;
+		bool		back = false;
+		bool		left = false;
+		bool		right = false;
+		bool		jump = false;
+		glm::vec3	front = { 0.0f, 0.0f, 1.0f };
+	};
+
+	// What the render thread gets from the simulation, the latest tick
+	// plus every world change since the last snapshot it took
+	struct FrameSnapshot
+	{
+		uint64_t					tick = 0;
+		double						time = 0.0;
+		glm::vec3					playerPos;
+		glm::vec3					cameraPos;
+		glm::vec3					previousCameraPos;
+		GameModule::WorldChanges	changes;
+	};
+
 	class Application
 	{
 	public:
@@ -34,18 +56,24 @@ namespace App
 		Application& operator=(Application&&) = delete;
 
 		void run();
+		void setTickRate(float ticksPerSecond);
 
 	private:
 		void init();
 		void initShaders();
-		void initTextures();
+		void initTextures(const Engine::TextureArrayData& data);
 		void initPlayer();
 		void onRender();
-		void onUpdate(float dt);
+		void onInput();
+		void onUpdate(float dt, const SimInput& input);
+		void simulate();
+		void publishSnapshot(const glm::vec3& previousCameraPos);
+		void takeSnapshot();
 		void handleCamera(const double xPos, const double yPos);
 		void handleInput();
 		
-		bool									m_isRunning = false;
+		std::atomic<bool>						m_isRunning{ false };
+		float									m_tickTime = 1.0f / 60.0f;
 		bool									m_keyboard[1024];
 		bool									m_keyboardPressed[1024];
 		GLFWwindow*								m_window = nullptr;
@@ -55,7 +83,17 @@ namespace App
 		Engine::TextureArray					m_tArray;
 
 		GameModule::World						m_world;
-		GameModule::Player						m_player;
+		GameModule::Player						m_player; // Owned by the simulation thread
+		GameModule::Player						m_renderPlayer; // Interpolated copy, the mouse turns it directly
+		GameModule::Entities					m_entities; // Owned by the simulation thread
+
+		std::thread								m_simThread;
+		std::mutex								m_snapshotMutex; // Guards m_snapshot, m_input and m_solidityChanges
+		FrameSnapshot							m_snapshot;
+		SimInput								m_input;
+		GameModule::SolidityChanges				m_solidityChanges;
+		FrameSnapshot							m_renderSnapshot;
+		GameModule::WorldChanges				m_simChanges;
 
 		Engine::Ray								m_ray;
 		Engine::Renderer::Buffer				m_rayBuffer;
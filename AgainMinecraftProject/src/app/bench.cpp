@@ -0,0 +1,1190 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../engine/renderer/commands.h"
+#include "../engine/renderer/staging.h"
+#include "../engine/profiler/profiler.h"
+#include "../engine/memory/alloc_counter.h"
+#include "../engine/shader/shader.h"
+#include "../engine/jobs/jobs.h"
+#include "../engine/noise/noise.h"
+
+#include "../modules/chunk/chunk.h"
+#include "../modules/chunk/biome.h"
+#include "../modules/world/world.h"
+#include "../modules/world/collision.h"
+#include "../modules/world/light.h"
+#include "../modules/world/population.h"
+#include "../modules/world/visibility.h"
+#include "../modules/player/player.h"
+#include "../modules/entity/entity.h"
+
+#include "bench.h"
+
+using namespace GameModule;
+
+using BenchClock = std::chrono::steady_clock;
+
+constexpr uint32_t g_warmupFrames = 60;
+constexpr uint32_t g_measuredFrames = 240;
+
+constexpr uint32_t g_collisionQueries = 200000;
+constexpr float g_maxQueryMove = 2.0f;
+constexpr float g_contactTolerance = 0.001f;
+
+constexpr uint32_t g_benchEntities = 10000;
+constexpr uint32_t g_benchEntityTicks = 200;
+constexpr float g_benchTickRate = 20.0f;
+
+constexpr uint32_t g_stillFluidSteps = 100;
+constexpr uint32_t g_maxFluidSteps = 2000;
+
+constexpr int32_t g_beachCarveDepth = 3;
+
+constexpr int32_t g_benchLightGrid = 16;
+constexpr int32_t g_benchLightRuns = 3;
+
+constexpr int32_t g_benchEditSpacing = 5;
+constexpr int32_t g_benchFloatingY = 200;
+constexpr uint32_t g_benchHeightQueries = 4096;
+
+constexpr int32_t g_benchTerrainChunks = 8; // Per side
+constexpr uint32_t g_benchNoisePoints = 4099; // Not a multiple of four, the tail of a batch gets checked too
+constexpr float g_lightBudgetMs = 1.0f;
+
+constexpr int32_t g_benchBiomeChunks = 32; // Per side, several climate regions
+constexpr float g_maxBiomeStep = 1.0f; // Blocks the height offset may change between two columns
+
+constexpr int32_t g_benchGroundY = 128;
+constexpr int32_t g_benchRoomY = 40;
+constexpr int32_t g_benchTunnelChunks = 3;
+constexpr uint32_t g_benchVisibilityFrames = 100;
+
+constexpr size_t g_benchRingSize = 1024 * 1024;
+constexpr uint32_t g_benchRingFrames = 10000;
+constexpr uint32_t g_framesInFlight = 3;
+
+float getElapsedMs(const BenchClock::time_point& start)
+{
+	return std::chrono::duration<float, std::milli>(BenchClock::now() - start).count();
+}
+
+// World is too big for the stack, its uploads go to the mock backend
+std::unique_ptr<World> makeBenchWorld()
+{
+	std::unique_ptr<World> world = std::make_unique<World>();
+	world->commands.backend = Engine::Renderer::Backend::MOCK;
+	initWorldChunks(*world);
+	return world;
+}
+
+void benchChunkMemory()
+{
+	const BenchClock::time_point start = BenchClock::now();
+	std::unique_ptr<World> world = makeBenchWorld();
+	const float elapsed = getElapsedMs(start);
+
+	const WorldMemory memory = getWorldMemory(*world);
+	const size_t chunks = std::max(memory.chunks, 1u);
+
+	std::cout
+		<< "chunk memory: " << memory.chunks << " chunks loaded in " << elapsed << " ms\n"
+		<< "  blocks      " << memory.blockBytes / chunks << " B/chunk\n"
+		<< "  cpu meshes  " << memory.meshBytes / chunks << " B/chunk, "
+		<< memory.meshSlackBytes / chunks << " B/chunk unused capacity\n"
+		<< "  gpu meshes  " << memory.gpuMeshBytes / chunks << " B/chunk\n"
+		<< "  total       " << (memory.blockBytes + memory.meshBytes + memory.meshSlackBytes + memory.gpuMeshBytes) / chunks << " B/chunk\n"
+		<< "  pool        " << memory.activeBuffers << " / " << memory.poolSize << " buffers\n";
+
+	releaseUploadedMeshes(*world);
+	const WorldMemory released = getWorldMemory(*world);
+
+	std::cout
+		<< "  released    " << released.meshBytes / chunks << " B/chunk cpu meshes, "
+		<< released.meshSlackBytes / chunks << " B/chunk unused capacity\n";
+}
+
+void initBenchPlayer(Player& player)
+{
+	player = {};
+	player.pos = { g_chunksX * 8.0f, 160.0f, g_chunksZ * 8.0f };
+	player.camera.pos = player.pos;
+	player.camera.front = { 0.0f, -0.3f, 1.0f };
+	player.camera.up = { 0.0f, 1.0f, 0.0f };
+	player.camera.nearPlane = 0.1f;
+	player.camera.farPlane = 200.0f;
+	player.camera.projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f,
+		player.camera.nearPlane, player.camera.farPlane);
+}
+
+void renderBenchFrame(World& world, Player& player, Engine::Shader& shader)
+{
+	Engine::Renderer::resetCommandStats(world.commands);
+	Engine::resetFrameArena(world.frameArena);
+
+	player.camera.view = glm::lookAt(player.camera.pos, player.camera.pos + player.camera.front, player.camera.up);
+
+	updateFrameData(world, player);
+	drawWorlToSM(world, player, shader);
+	drawWorld(world, player, shader);
+}
+
+// Frames after the warmup must not allocate, the camera moves
+// so water sorting and cascade fitting run as well
+bool benchSteadyFrames()
+{
+	std::unique_ptr<World> world = makeBenchWorld();
+
+	Player player;
+	initBenchPlayer(player);
+	world->shadowCascadeLevels = { player.camera.farPlane / 20.0f, player.camera.farPlane / 5.0f };
+
+	Engine::Shader shader = {};
+
+	for (uint32_t frame = 0; frame < g_warmupFrames; frame++)
+	{
+		renderBenchFrame(*world, player, shader);
+		player.camera.pos.x += 0.1f;
+	}
+
+#ifdef TRACK_ALLOCATIONS
+	const uint64_t allocations = Engine::getAllocationCount();
+#endif
+	const BenchClock::time_point start = BenchClock::now();
+	for (uint32_t frame = 0; frame < g_measuredFrames; frame++)
+	{
+		renderBenchFrame(*world, player, shader);
+		player.camera.pos.x += 0.1f;
+	}
+	const float elapsed = getElapsedMs(start);
+#ifdef TRACK_ALLOCATIONS
+	const uint64_t frameAllocations = Engine::getAllocationCount() - allocations;
+#endif
+
+	const Engine::Renderer::CommandStats& stats = world->commands.stats;
+	std::cout
+		<< "steady frames: " << g_measuredFrames << " frames, " << elapsed / g_measuredFrames << " ms/frame\n"
+		<< "  commands    " << stats.commands << ", " << stats.filtered << " filtered, "
+		<< stats.drawCalls << " draw calls\n";
+#ifdef TRACK_ALLOCATIONS
+	std::cout << "  allocations " << frameAllocations << "\n";
+	assert(frameAllocations == 0);
+	return frameAllocations == 0;
+#else
+	std::cout << "  allocations not tracked, build with TRACK_ALLOCATIONS\n";
+	return true;
+#endif
+}
+
+void setBenchBlock(SolidMask& mask, int32_t x, int32_t y, int32_t z)
+{
+	const uint32_t id = 16 * (y * 16 + z) + x;
+	mask.bits[id >> 6] |= uint64_t(1) << (id & 63);
+}
+
+// True when the box overlaps a solid block it didn't overlap before the move,
+// contact closer than the collision skin counts as touching
+bool isPenetrating(const World& world, const AABB& start, const AABB& box)
+{
+	const glm::ivec3 min = glm::floor(box.min + g_contactTolerance);
+	const glm::ivec3 max = glm::ivec3(glm::ceil(box.max - g_contactTolerance)) - 1;
+	for (int32_t y = min.y; y <= max.y; y++)
+	{
+		for (int32_t z = min.z; z <= max.z; z++)
+		{
+			for (int32_t x = min.x; x <= max.x; x++)
+			{
+				const bool inStart =
+					start.max.x > x && start.min.x < x + 1 &&
+					start.max.y > y && start.min.y < y + 1 &&
+					start.max.z > z && start.min.z < z + 1;
+				if (!inStart && isSolid(world, { x, y, z }))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// A floor with a one block step and a wall two blocks above it, then random moves through generated terrain
+bool benchCollision()
+{
+	bool passed = true;
+	{
+		std::unique_ptr<World> world = std::make_unique<World>();
+		SolidMask& mask = world->solidity[{ 0, 0, 0 }];
+		mask.bits.fill(0);
+		for (int32_t z = 0; z < 16; z++)
+		{
+			for (int32_t x = 0; x < 16; x++)
+			{
+				setBenchBlock(mask, x, 10, z);
+				if (x >= 8)
+				{
+					setBenchBlock(mask, x, 11, z);
+				}
+				if (z == 12)
+				{
+					setBenchBlock(mask, x, 11, z);
+					setBenchBlock(mask, x, 12, z);
+					setBenchBlock(mask, x, 13, z);
+				}
+			}
+		}
+
+		const glm::vec3 size = { 0.6f, 1.8f, 0.6f };
+		AABB box = { glm::vec3(6.0f, 11.001f, 4.0f), glm::vec3(6.0f, 11.001f, 4.0f) + size };
+		passed &= isOnGround(*world, box);
+
+		const CollisionResult step = moveAABB(*world, box, { 3.0f, 0.0f, 0.0f }, 1.0f);
+		passed &= step.stepped && step.onGround && box.min.y > 12.0f && box.min.x > 8.9f;
+
+		const CollisionResult wall = moveAABB(*world, box, { 0.0f, 0.0f, 9.0f }, 1.0f);
+		passed &= wall.hitZ && !wall.stepped && box.max.z <= 12.0f;
+
+		const CollisionResult fall = moveAABB(*world, box, { 0.0f, -5.0f, 0.0f }, 1.0f);
+		passed &= fall.hitY && fall.onGround && box.min.y >= 12.0f;
+	}
+
+	std::unique_ptr<World> world = makeBenchWorld();
+
+	uint32_t random = 777;
+	auto next = [&random]() {
+		random = random * 1664525 + 1013904223;
+		return (random >> 8) / float(1 << 24);
+	};
+
+	uint32_t hits = 0;
+	uint32_t penetrations = 0;
+	float elapsed = 0.0f;
+	for (uint32_t query = 0; query < g_collisionQueries; query++)
+	{
+		const glm::vec3 pos = {
+			16.0f + next() * (g_chunksX - 2) * 16.0f,
+			40.0f + next() * 120.0f,
+			16.0f + next() * (g_chunksZ - 2) * 16.0f };
+		const glm::vec3 delta = (glm::vec3(next(), next(), next()) * 2.0f - 1.0f) * g_maxQueryMove;
+
+		const AABB start = { pos, pos + glm::vec3(0.6f, 1.8f, 0.6f) };
+		AABB box = start;
+
+		const BenchClock::time_point queryStart = BenchClock::now();
+		const CollisionResult result = moveAABB(*world, box, delta, 1.0f);
+		elapsed += getElapsedMs(queryStart);
+
+		hits += result.hitX || result.hitY || result.hitZ;
+		penetrations += isPenetrating(*world, start, box);
+	}
+	passed &= penetrations == 0;
+
+	std::cout
+		<< "collision: " << g_collisionQueries / (elapsed / 1000.0f) / 1000000.0f << " M queries/s, "
+		<< hits << " of " << g_collisionQueries << " blocked\n"
+		<< "  step, wall and ground " << (passed ? "ok" : "FAILED") << ", "
+		<< penetrations << " penetrations\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Mobs with a sight ray and items dropped over generated terrain, ticked without a renderer
+// until they all lie on the ground, none of them may end up inside a block
+bool benchEntities()
+{
+	std::unique_ptr<World> world = makeBenchWorld();
+
+	const uint32_t cores = std::thread::hardware_concurrency();
+	Engine::initJobs(cores > 1 ? cores - 1 : 0);
+
+	uint32_t random = 4242;
+	auto next = [&random]() {
+		random = random * 1664525 + 1013904223;
+		return (random >> 8) / float(1 << 24);
+	};
+
+	Entities entities;
+	for (uint32_t i = 0; i < g_benchEntities; i++)
+	{
+		const Entity entity = createEntity(entities);
+		const glm::vec3 pos = {
+			16.0f + next() * (g_chunksX - 2) * 16.0f,
+			244.0f + next() * 8.0f, // Above the highest peaks
+			16.0f + next() * (g_chunksZ - 2) * 16.0f };
+
+		// Every other one is an item, it only falls
+		if (i % 2)
+		{
+			addBody(entities, entity, pos, { 0.25f, 0.25f, 0.25f });
+			continue;
+		}
+
+		addBody(entities, entity, pos, { 0.6f, 1.8f, 0.6f });
+		entities.bodies.velocity.back() = glm::vec3(next() * 2.0f - 1.0f, 0.0f, next() * 2.0f - 1.0f) * 4.0f;
+		addSight(entities, entity, glm::vec3(next() * 2.0f - 1.0f, -0.5f, next() * 2.0f - 1.0f), 32.0f);
+	}
+
+	const float dt = 1.0f / g_benchTickRate;
+	float elapsed = 0.0f;
+	float slowest = 0.0f;
+	for (uint32_t tick = 0; tick < g_benchEntityTicks; tick++)
+	{
+		const BenchClock::time_point start = BenchClock::now();
+		updateEntities(*world, entities, dt);
+		const float tickTime = getElapsedMs(start);
+
+		elapsed += tickTime;
+		slowest = std::max(slowest, tickTime);
+	}
+	const uint32_t threads = Engine::getJobThreadCount() + 1;
+	Engine::shutdownJobs();
+
+	const AABB outside = { glm::vec3(-1.0f), glm::vec3(-1.0f) };
+	uint32_t penetrations = 0;
+	uint32_t grounded = 0;
+	for (uint32_t i = 0; i < entities.bodies.slots.size(); i++)
+	{
+		const glm::vec3 pos = entities.bodies.pos[i];
+		penetrations += isPenetrating(*world, outside, { pos, pos + entities.bodies.size[i] });
+		grounded += entities.bodies.onGround[i];
+	}
+
+	uint32_t seeing = 0;
+	for (uint32_t i = 0; i < entities.sights.slots.size(); i++)
+	{
+		seeing += entities.sights.hitDistance[i] < entities.sights.range[i];
+	}
+
+	const bool passed = penetrations == 0 && grounded == entities.alive;
+
+	std::cout
+		<< "entities: " << entities.alive << " ticked " << g_benchEntityTicks << " times on "
+		<< threads << " threads\n"
+		<< "  tick        " << elapsed / g_benchEntityTicks << " ms average, " << slowest << " ms slowest, "
+		<< 1000.0f / (elapsed / g_benchEntityTicks) << " ticks/s\n"
+		<< "  bodies      " << grounded << " on the ground, " << penetrations << " inside blocks\n"
+		<< "  sights      " << seeing << " of " << entities.sights.slots.size() << " see a block\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Of every block of the loaded chunks, visited in chunk order
+uint64_t hashBlocks(const World& world)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (int32_t z = 0; z < g_chunksZ; z++)
+	{
+		for (int32_t x = 0; x < g_chunksX; x++)
+		{
+			for (const Block& block : world.chunks.at({ x * 16, 0, z * 16 }).blocks)
+			{
+				hash = (hash ^ static_cast<uint8_t>(block.type)) * 1099511628211ull;
+				hash = (hash ^ block.data) * 1099511628211ull;
+			}
+		}
+	}
+	return hash;
+}
+
+struct FluidRun
+{
+	uint32_t	steps;
+	uint32_t	cells;
+	uint32_t	changed;
+	uint32_t	remeshed;
+	float		stepMs;
+	float		remeshMs;
+};
+
+// Steps until no cell is queued anymore
+FluidRun settleFluids(World& world)
+{
+	FluidRun run = {};
+	for (; run.steps < g_maxFluidSteps; run.steps++)
+	{
+		run.remeshed += static_cast<uint32_t>(world.chunksToRemesh.size());
+
+		BenchClock::time_point start = BenchClock::now();
+		remeshEditedChunks(world);
+		run.remeshMs += getElapsedMs(start);
+
+		start = BenchClock::now();
+		const FluidStep step = stepFluids(world);
+		run.stepMs += getElapsedMs(start);
+
+		if (step.cells == 0)
+		{
+			break;
+		}
+		run.cells += step.cells;
+		run.changed += step.changed;
+	}
+	return run;
+}
+
+// Water poured on the corner of four chunks runs down, spreads and dries up again once the source is
+// gone. Still water never gets stepped and the result doesn't depend on which thread steps a chunk.
+bool benchFluids()
+{
+	const uint32_t cores = std::thread::hardware_concurrency();
+	const glm::ivec3 corner = { 8 * 16, 0, 8 * 16 };
+
+	uint64_t hashes[2];
+	FluidRun flow = {};
+	FluidRun dry = {};
+	float stillMs = 0.0f;
+	bool passed = true;
+
+	// Without job threads and then with a few, so chunks finish in a different order
+	for (uint32_t run = 0; run < 2; run++)
+	{
+		Engine::initJobs(run == 0 ? 0 : std::max(cores, 4u) - 1);
+
+		std::unique_ptr<World> world = makeBenchWorld();
+		const uint64_t generated = hashBlocks(*world);
+
+		const BenchClock::time_point start = BenchClock::now();
+		for (uint32_t step = 0; step < g_stillFluidSteps; step++)
+		{
+			passed &= stepFluids(*world).cells == 0;
+		}
+		stillMs = getElapsedMs(start) / g_stillFluidSteps;
+
+		const glm::ivec3 source = corner + glm::ivec3(0, getSurfaceHeight(*world, corner.x, corner.z) + 4, 0);
+
+		setBlock(*world, source, { BlockType::WATER, 0 });
+		flow = settleFluids(*world);
+		hashes[run] = hashBlocks(*world);
+
+		setBlock(*world, source, { BlockType::AIR, 0 });
+		dry = settleFluids(*world);
+		passed &= hashBlocks(*world) == generated;
+		passed &= flow.steps < g_maxFluidSteps && dry.steps < g_maxFluidSteps;
+
+		Engine::shutdownJobs();
+	}
+	passed &= hashes[0] == hashes[1];
+
+	std::cout
+		<< "fluids: still water " << stillMs << " ms/step\n"
+		<< "  flow        " << flow.steps << " steps, " << flow.cells << " cells stepped, " << flow.changed << " changed, "
+		<< flow.stepMs / flow.steps << " ms/step, " << flow.remeshed << " chunks remeshed in " << flow.remeshMs << " ms\n"
+		<< "  dry up      " << dry.steps << " steps, " << dry.cells << " cells stepped, " << dry.changed << " changed, "
+		<< dry.stepMs / dry.steps << " ms/step\n"
+		<< "  threads     " << (hashes[0] == hashes[1] ? "same result" : "DIFFERENT results") << "\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Every beach of the world loses the blocks under its sand at once,
+// all of the sand has to land in a single pass
+bool benchFallingBlocks()
+{
+	std::unique_ptr<World> world = makeBenchWorld();
+
+	// Sand on top of a column and above the water, on ground that is solid as deep as the carving
+	// and one further, deserts have overhangs and caves right under their sand
+	std::vector<glm::ivec3> beach;
+	for (int32_t z = 0; z < g_chunksZ * 16; z++)
+	{
+		for (int32_t x = 0; x < g_chunksX * 16; x++)
+		{
+			const glm::ivec3 top = { x, getSurfaceHeight(*world, x, z) - 1, z };
+			bool grounded = true;
+			for (int32_t depth = 1; depth <= g_beachCarveDepth + 1; depth++)
+			{
+				grounded &= isSolidBlock(findBlock(*world, top - glm::ivec3(0, depth, 0))->type);
+			}
+			const BlockType ground = findBlock(*world, top - glm::ivec3(0, g_beachCarveDepth + 1, 0))->type;
+			if (findBlock(*world, top)->type == BlockType::SAND && grounded && !isFallingBlock(ground))
+			{
+				beach.push_back(top);
+			}
+		}
+	}
+
+	for (const glm::ivec3& top : beach)
+	{
+		for (int32_t depth = 1; depth <= g_beachCarveDepth; depth++)
+		{
+			setBlock(*world, top - glm::ivec3(0, depth, 0), { BlockType::AIR, 0 });
+		}
+	}
+	world->chunksToRemesh.clear();
+
+	BenchClock::time_point start = BenchClock::now();
+	const SettlePass pass = settleColumns(*world);
+	const float settleMs = getElapsedMs(start);
+
+	const uint32_t remeshed = static_cast<uint32_t>(world->chunksToRemesh.size());
+	start = BenchClock::now();
+	remeshEditedChunks(*world);
+	const float remeshMs = getElapsedMs(start);
+
+	const SettlePass again = settleColumns(*world);
+
+	bool passed = again.moved == 0 && world->unsettled.empty();
+	for (const glm::ivec3& top : beach)
+	{
+		const glm::ivec3 landed = top - glm::ivec3(0, g_beachCarveDepth, 0);
+		passed &= findBlock(*world, landed)->type == BlockType::SAND;
+		passed &= findBlock(*world, landed + glm::ivec3(0, 1, 0))->type != BlockType::SAND;
+		passed &= isSolidBlock(findBlock(*world, landed - glm::ivec3(0, 1, 0))->type);
+	}
+
+	std::cout
+		<< "falling blocks: " << beach.size() << " beach columns carved " << g_beachCarveDepth << " deep\n"
+		<< "  settle      " << pass.columns << " columns in " << pass.chunks << " chunks, "
+		<< pass.moved << " blocks written in " << settleMs << " ms\n"
+		<< "  remesh      " << remeshed << " chunks once in " << remeshMs << " ms\n"
+		<< "  second pass " << again.moved << " blocks written, sand " << (passed ? "landed" : "NOT landed") << "\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Swaps the type of the cell the way setBlock does, but times only the light update
+float timeBlockLight(World& world, const glm::ivec3& pos, BlockType type)
+{
+	const glm::ivec3 chunkPos = getChunkOrigin(pos);
+	const glm::ivec3 local = pos - chunkPos;
+	Block& cell = world.chunks.at(chunkPos).blocks[16 * (16 * local.y + local.z) + local.x];
+	const Block previous = cell;
+	cell.type = type;
+
+	const BenchClock::time_point start = BenchClock::now();
+	updateBlockLight(world, pos, previous);
+	return getElapsedMs(start);
+}
+
+// A lamp is placed above the ground and taken away again all over the world, the light of every
+// edit is reported against the budget and has to leave no light behind. Taking away one of two
+// overlapping lamps has to leave the same light as if only the other one had ever been placed.
+bool benchBlockLight()
+{
+	std::unique_ptr<World> world = makeBenchWorld();
+	const uint64_t generated = hashBlocks(*world);
+
+	const glm::ivec3 up = { 0, 1, 0 };
+	const int32_t spacing = (g_chunksX - 2) * 16 / g_benchLightGrid;
+
+	float placeMs = 0.0f;
+	float removeMs = 0.0f;
+	float maxMs = 0.0f;
+	bool passed = true;
+	for (int32_t i = 0; i < g_benchLightGrid * g_benchLightGrid; i++)
+	{
+		const int32_t x = 16 + i % g_benchLightGrid * spacing;
+		const int32_t z = 16 + i / g_benchLightGrid * spacing;
+		const glm::ivec3 lamp = { x, getSurfaceHeight(*world, x, z), z };
+
+		// The best of a few tries, one the thread got preempted in says nothing about the light
+		float placed = std::numeric_limits<float>::max();
+		float removed = std::numeric_limits<float>::max();
+		for (int32_t run = 0; run < g_benchLightRuns; run++)
+		{
+			placed = std::min(placed, timeBlockLight(*world, lamp, BlockType::LAMP));
+			passed &= getBlockLight(*findBlock(*world, lamp + up)) == g_maxLight - 1;
+			removed = std::min(removed, timeBlockLight(*world, lamp, BlockType::AIR));
+		}
+
+		placeMs += placed;
+		removeMs += removed;
+		maxMs = std::max(maxMs, std::max(placed, removed));
+	}
+	passed &= hashBlocks(*world) == generated;
+
+	const glm::ivec3 first = { 8 * 16, getSurfaceHeight(*world, 8 * 16, 8 * 16), 8 * 16 };
+	const glm::ivec3 second = first + glm::ivec3(3, 4, 0);
+
+	setBlock(*world, second, { BlockType::LAMP, 0 });
+	const uint64_t alone = hashBlocks(*world);
+	setBlock(*world, second, { BlockType::AIR, 0 });
+	world->chunksToRemesh.clear();
+
+	setBlock(*world, first, { BlockType::LAMP, 0 });
+	const uint32_t remeshed = static_cast<uint32_t>(world->chunksToRemesh.size());
+	BenchClock::time_point start = BenchClock::now();
+	remeshEditedChunks(*world);
+	const float remeshMs = getElapsedMs(start);
+
+	setBlock(*world, second, { BlockType::LAMP, 0 });
+	setBlock(*world, first, { BlockType::AIR, 0 });
+	const bool overlap = hashBlocks(*world) == alone;
+	setBlock(*world, second, { BlockType::AIR, 0 });
+	passed &= overlap && hashBlocks(*world) == generated;
+
+	const uint32_t lamps = g_benchLightGrid * g_benchLightGrid;
+	std::cout
+		<< "block light: " << lamps << " lamps placed and removed, best of " << g_benchLightRuns << "\n"
+		<< "  place       " << placeMs / lamps << " ms avg\n"
+		<< "  remove      " << removeMs / lamps << " ms avg\n"
+		<< "  worst edit  " << maxMs << " ms, " << (maxMs <= g_lightBudgetMs ? "within" : "OVER") << " the "
+		<< g_lightBudgetMs << " ms budget\n"
+		<< "  remesh      " << remeshed << " chunks for one lamp in " << remeshMs << " ms\n"
+		<< "  overlapping " << (overlap ? "relit" : "NOT relit") << ", light " << (passed ? "cleared" : "LEFT behind") << "\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Top of the column looked up block by block, what getSurfaceHeight answers from the heights
+int32_t scanSurfaceHeight(const World& world, int32_t x, int32_t z)
+{
+	glm::ivec3 top = { x, 255, z };
+	while (top.y >= 0 && findBlock(world, top)->type == BlockType::AIR)
+	{
+		top.y--;
+	}
+	return top.y + 1;
+}
+
+// Columns whose heights or ground in the solid mask don't match their blocks
+uint32_t countHeightMismatches(const World& world)
+{
+	uint32_t mismatches = 0;
+	for (const auto& pair : world.chunks)
+	{
+		const Chunk& chunk = pair.second;
+		for (uint32_t column = 0; column < g_chunkColumns; column++)
+		{
+			uint16_t opaque = 0;
+			uint16_t surface = 0;
+			for (uint32_t y = 0; y < 256; y++)
+			{
+				const BlockType type = chunk.blocks[g_chunkColumns * y + column].type;
+				opaque = isSolidBlock(type) ? y + 1 : opaque;
+				surface = type != BlockType::AIR ? y + 1 : surface;
+			}
+
+			const int32_t ground = getGroundHeight(world, pair.first.x + column % 16, pair.first.z + column / 16);
+			if (chunk.heights.opaque[column] != opaque || chunk.heights.surface[column] != surface || ground != opaque)
+			{
+				mismatches++;
+			}
+		}
+	}
+	return mismatches;
+}
+
+// The heights have to match the blocks after generation, after digging into the surface and
+// building above it all over the world and after taking that away again. The simulation side
+// follows once the solidity changes are handed over.
+bool benchHeightMaps()
+{
+	std::unique_ptr<World> world = makeBenchWorld();
+
+	uint32_t mismatches = countHeightMismatches(*world);
+
+	std::vector<glm::ivec3> floating;
+	for (int32_t z = 0; z < g_chunksZ * 16; z += g_benchEditSpacing)
+	{
+		for (int32_t x = 0; x < g_chunksX * 16; x += g_benchEditSpacing)
+		{
+			const int32_t top = getSurfaceHeight(*world, x, z) - 1;
+			setBlock(*world, { x, top, z }, { BlockType::AIR, 0 });
+			setBlock(*world, { x, top - 1, z }, { BlockType::AIR, 0 });
+
+			floating.push_back({ x, std::max(top + 2, g_benchFloatingY), z });
+			setBlock(*world, floating.back(), { BlockType::STONE, 0 });
+		}
+	}
+
+	SolidityChanges changes;
+	collectSolidityChanges(*world, changes);
+	applySolidityChanges(*world, changes);
+	mismatches += countHeightMismatches(*world);
+
+	for (const glm::ivec3& pos : floating)
+	{
+		setBlock(*world, pos, { BlockType::AIR, 0 });
+	}
+	collectSolidityChanges(*world, changes);
+	applySolidityChanges(*world, changes);
+	mismatches += countHeightMismatches(*world);
+
+	int64_t scanned = 0;
+	BenchClock::time_point start = BenchClock::now();
+	for (uint32_t i = 0; i < g_benchHeightQueries; i++)
+	{
+		scanned += scanSurfaceHeight(*world, i * 7 % (g_chunksX * 16), i * 13 % (g_chunksZ * 16));
+	}
+	const float scanMs = getElapsedMs(start);
+
+	int64_t looked = 0;
+	start = BenchClock::now();
+	for (uint32_t i = 0; i < g_benchHeightQueries; i++)
+	{
+		looked += getSurfaceHeight(*world, i * 7 % (g_chunksX * 16), i * 13 % (g_chunksZ * 16));
+	}
+	const float lookupMs = getElapsedMs(start);
+
+	const bool passed = mismatches == 0 && scanned == looked;
+
+	std::cout
+		<< "height maps: " << floating.size() << " columns dug into and built on\n"
+		<< "  columns     " << mismatches << " mismatches after generation and edits\n"
+		<< "  surface     " << g_benchHeightQueries << " queries, scanned in " << scanMs << " ms, looked up in "
+		<< lookupMs << " ms\n";
+
+	assert(passed);
+	return passed;
+}
+
+struct TerrainRun
+{
+	float		ms;
+	uint32_t	hidden; // Air and water under the highest opaque block of their column
+};
+
+TerrainRun generateTerrain(TerrainMode mode)
+{
+	TerrainRun run = {};
+	for (int32_t z = 0; z < g_benchTerrainChunks; z++)
+	{
+		for (int32_t x = 0; x < g_benchTerrainChunks; x++)
+		{
+			const BenchClock::time_point start = BenchClock::now();
+			const Chunk chunk = generateChunk({ x * 16, 0, z * 16 }, mode);
+			run.ms += getElapsedMs(start);
+
+			for (uint32_t id = 0; id < chunk.blocks.size(); id++)
+			{
+				if (!isSolidBlock(chunk.blocks[id].type) && id / g_chunkColumns < chunk.heights.opaque[id % g_chunkColumns])
+				{
+					run.hidden++;
+				}
+			}
+		}
+	}
+	return run;
+}
+
+// Both terrain modes generate the same chunks, only the density one may leave room under the
+// surface. The batched noise it samples its grid with has to match the scalar one.
+bool benchTerrainModes()
+{
+	std::vector<float> x(g_benchNoisePoints), y(g_benchNoisePoints), z(g_benchNoisePoints), batched(g_benchNoisePoints);
+	for (uint32_t i = 0; i < g_benchNoisePoints; i++)
+	{
+		x[i] = i * 0.37f - 700.0f;
+		y[i] = i * 0.11f;
+		z[i] = 300.0f - i * 0.23f;
+	}
+	Engine::Noise::perlin3D(x.data(), y.data(), z.data(), batched.data(), g_benchNoisePoints);
+
+	float noiseError = 0.0f;
+	for (uint32_t i = 0; i < g_benchNoisePoints; i++)
+	{
+		noiseError = std::max(noiseError, std::abs(batched[i] - Engine::Noise::perlin3D(x[i], y[i], z[i])));
+	}
+
+	const TerrainRun heights = generateTerrain(TerrainMode::HEIGHTMAP);
+	const TerrainRun density = generateTerrain(TerrainMode::DENSITY);
+
+	const uint32_t chunks = g_benchTerrainChunks * g_benchTerrainChunks;
+	const bool passed = noiseError < 1e-5f && heights.hidden == 0 && density.hidden > 0;
+
+	std::cout
+		<< "terrain: " << chunks << " chunks per mode\n"
+		<< "  heightmap   " << heights.ms / chunks << " ms/chunk, " << heights.hidden << " blocks under the surface open\n"
+		<< "  density     " << density.ms / chunks << " ms/chunk, " << density.hidden << " blocks under the surface open, "
+		<< density.ms / heights.ms << "x the heightmap\n"
+		<< "  noise       batched off by " << noiseError << " at most\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Climate is cached per region, so only the first chunk of a region pays for the noise. Every
+// chunk has to come out the same from a cold and a warm cache, and biomes have to blend, the
+// height offset of neighbouring columns never jumps even across chunk and region borders.
+bool benchBiomes()
+{
+	const int32_t side = g_benchBiomeChunks * 16;
+	const int32_t origin = -side / 2;
+
+	std::vector<ChunkBiomes> cold(g_benchBiomeChunks * g_benchBiomeChunks);
+	ChunkBiomes warm;
+
+	clearClimateCache();
+	BenchClock::time_point start = BenchClock::now();
+	for (int32_t z = 0; z < g_benchBiomeChunks; z++)
+	{
+		for (int32_t x = 0; x < g_benchBiomeChunks; x++)
+		{
+			getChunkBiomes({ origin + x * 16, 0, origin + z * 16 }, cold[g_benchBiomeChunks * z + x]);
+		}
+	}
+	const float coldMs = getElapsedMs(start);
+	const ClimateCacheStats coldStats = getClimateCacheStats();
+
+	uint32_t differing = 0;
+	start = BenchClock::now();
+	for (int32_t z = 0; z < g_benchBiomeChunks; z++)
+	{
+		for (int32_t x = 0; x < g_benchBiomeChunks; x++)
+		{
+			getChunkBiomes({ origin + x * 16, 0, origin + z * 16 }, warm);
+
+			const ChunkBiomes& first = cold[g_benchBiomeChunks * z + x];
+			for (uint32_t column = 0; column < g_chunkColumns; column++)
+			{
+				differing += first[column].type != warm[column].type ||
+					first[column].heightOffset != warm[column].heightOffset ||
+					first[column].heightScale != warm[column].heightScale;
+			}
+		}
+	}
+	const float warmMs = getElapsedMs(start);
+	const ClimateCacheStats warmStats = getClimateCacheStats();
+
+	auto getColumn = [&cold](int32_t x, int32_t z) -> const ColumnBiome& {
+		return cold[g_benchBiomeChunks * (z / 16) + x / 16][16 * (z % 16) + x % 16];
+	};
+
+	float maxStep = 0.0f;
+	std::array<uint32_t, 5> counts = {};
+	for (int32_t z = 0; z < side; z++)
+	{
+		for (int32_t x = 0; x < side; x++)
+		{
+			const ColumnBiome& column = getColumn(x, z);
+			counts[static_cast<uint32_t>(column.type)]++;
+			if (x + 1 < side)
+			{
+				maxStep = std::max(maxStep, std::abs(getColumn(x + 1, z).heightOffset - column.heightOffset));
+			}
+			if (z + 1 < side)
+			{
+				maxStep = std::max(maxStep, std::abs(getColumn(x, z + 1).heightOffset - column.heightOffset));
+			}
+		}
+	}
+	const uint32_t present = static_cast<uint32_t>(std::count_if(counts.begin(), counts.end(),
+		[](uint32_t count) { return count > 0; }));
+
+	start = BenchClock::now();
+	generateChunk({ origin, 0, origin }, TerrainMode::HEIGHTMAP);
+	const float generateMs = getElapsedMs(start);
+
+	const uint32_t chunks = g_benchBiomeChunks * g_benchBiomeChunks;
+	const uint32_t warmHits = static_cast<uint32_t>(warmStats.hits - coldStats.hits);
+	const bool passed = differing == 0 && maxStep < g_maxBiomeStep && present > 1 &&
+		warmHits == chunks && warmStats.misses == coldStats.misses;
+
+	std::cout
+		<< "biomes: " << chunks << " chunks in " << coldStats.tiles << " climate regions\n"
+		<< "  cold        " << coldMs / chunks << " ms/chunk, " << coldStats.misses << " regions sampled\n"
+		<< "  warm        " << warmMs / chunks << " ms/chunk, " << warmHits << " hits, " << differing
+		<< " columns differ, generating a chunk takes " << generateMs << " ms\n"
+		<< "  blending    height offset moves " << maxStep << " blocks at most between columns\n"
+		<< "  columns     plains " << counts[0] << ", forest " << counts[1] << ", desert " << counts[2]
+		<< ", mountains " << counts[3] << ", tundra " << counts[4] << "\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Chunks streamed in one by one, in the opposite order, have to end up with the same features as
+// the world populated at once. Only chunks with all eight neighbours get populated.
+bool benchPopulation()
+{
+	std::unique_ptr<World> world = makeBenchWorld();
+
+	std::unique_ptr<World> streamed = std::make_unique<World>();
+	PopulatePass total = {};
+	float populateMs = 0.0f;
+	for (int32_t z = g_chunksZ - 1; z >= 0; z--)
+	{
+		for (int32_t x = g_chunksX - 1; x >= 0; x--)
+		{
+			const glm::ivec3 pos = { x * 16, 0, z * 16 };
+			streamed->chunks[pos] = generateChunk(pos, streamed->terrain);
+
+			const BenchClock::time_point start = BenchClock::now();
+			const PopulatePass pass = populateChunks(*streamed);
+			populateMs += getElapsedMs(start);
+
+			total.chunks += pass.chunks;
+			total.features += pass.features;
+			total.writes += pass.writes;
+			total.crossing += pass.crossing;
+		}
+	}
+
+	uint32_t populated = 0;
+	uint32_t edgesPopulated = 0;
+	for (const auto& pair : world->chunks)
+	{
+		const int32_t x = pair.first.x / 16;
+		const int32_t z = pair.first.z / 16;
+		const bool edge = x == 0 || z == 0 || x == g_chunksX - 1 || z == g_chunksZ - 1;
+		populated += pair.second.populated;
+		edgesPopulated += edge && (pair.second.populated || streamed->chunks.at(pair.first).populated);
+	}
+
+	const uint32_t interior = (g_chunksX - 2) * (g_chunksZ - 2);
+	const uint32_t mismatches = countHeightMismatches(*world);
+	const bool sameBlocks = hashBlocks(*world) == hashBlocks(*streamed);
+	const bool passed = sameBlocks && populated == interior && total.chunks == interior && edgesPopulated == 0 &&
+		total.features > 0 && total.crossing > 0 && mismatches == 0;
+
+	std::cout
+		<< "population: " << populated << " of " << world->chunks.size() << " chunks, the rest miss neighbours\n"
+		<< "  trees       " << total.features << " grown, " << total.writes << " blocks staged, "
+		<< total.crossing << " of them into neighbours\n"
+		<< "  streamed    " << populateMs / total.chunks << " ms/chunk, " << (sameBlocks ? "same blocks" : "DIFFERENT blocks")
+		<< " as populated at once\n"
+		<< "  columns     " << mismatches << " height mismatches\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Stone up to the ground, air above it
+Chunk makeFlatChunk(const glm::ivec3& pos)
+{
+	Chunk chunk;
+	chunk.pos = pos;
+	chunk.front = pos + glm::ivec3(0, 0, 16);
+	chunk.back = pos - glm::ivec3(0, 0, 16);
+	chunk.right = pos + glm::ivec3(16, 0, 0);
+	chunk.left = pos - glm::ivec3(16, 0, 0);
+	chunk.blocks.resize(g_chunkColumns * 256);
+	for (uint32_t id = 0; id < chunk.blocks.size(); id++)
+	{
+		chunk.blocks[id].type = id / g_chunkColumns < g_benchGroundY ? BlockType::STONE : BlockType::AIR;
+	}
+	chunk.heights.opaque.fill(g_benchGroundY);
+	chunk.heights.surface.fill(g_benchGroundY);
+	initChunkFaces(chunk);
+	return chunk;
+}
+
+void carveBenchBlock(World& world, const glm::ivec3& pos)
+{
+	Chunk& chunk = world.chunks.at(getChunkOrigin(pos));
+	const glm::ivec3 local = pos - getChunkOrigin(pos);
+	chunk.blocks[g_chunkColumns * local.y + 16 * local.z + local.x].type = BlockType::AIR;
+}
+
+struct VisibilityRun
+{
+	VisibilityStats	stats;
+	float			ms;			// Per search
+	uint32_t		drawCalls;	// Of a frame with the search
+};
+
+VisibilityRun runVisibility(World& world, Player& player)
+{
+	VisibilityRun run = {};
+	const BenchClock::time_point start = BenchClock::now();
+	for (uint32_t frame = 0; frame < g_benchVisibilityFrames; frame++)
+	{
+		run.stats = updateVisibility(world, player.camera.pos);
+	}
+	run.ms = getElapsedMs(start) / g_benchVisibilityFrames;
+
+	Engine::Shader shader = {};
+	renderBenchFrame(world, player, shader);
+	run.drawCalls = world.commands.stats.drawCalls;
+	return run;
+}
+
+// A flat world where the sky connects everything, a sealed room under it that sees only itself,
+// and a tunnel out of the room that sees the chunks it runs through. On the generated terrain a
+// camera deep under the surface has to draw less than with culling off.
+bool benchVisibility()
+{
+	const uint8_t right = 1 << static_cast<uint8_t>(SectionFace::RIGHT);
+	const uint8_t left = 1 << static_cast<uint8_t>(SectionFace::LEFT);
+
+	std::unique_ptr<World> flat = std::make_unique<World>();
+	for (int32_t z = 0; z < g_chunksZ; z++)
+	{
+		for (int32_t x = 0; x < g_chunksX; x++)
+		{
+			flat->chunks[{ x * 16, 0, z * 16 }] = makeFlatChunk({ x * 16, 0, z * 16 });
+		}
+	}
+
+	const glm::ivec3 roomChunk = { g_chunksX / 2 * 16, 0, g_chunksZ / 2 * 16 };
+	const glm::vec3 sky = glm::vec3(roomChunk) + glm::vec3(8.0f, 200.0f, 8.0f);
+	const VisibilityStats open = updateVisibility(*flat, sky);
+
+	for (int32_t y = 0; y < 3; y++)
+	{
+		for (int32_t z = 0; z < 3; z++)
+		{
+			for (int32_t x = 0; x < 3; x++)
+			{
+				carveBenchBlock(*flat, roomChunk + glm::ivec3(6 + x, g_benchRoomY + y, 6 + z));
+			}
+		}
+	}
+	linkChunkSections(flat->chunks.at(roomChunk));
+
+	const glm::vec3 room = glm::vec3(roomChunk) + glm::vec3(7.5f, g_benchRoomY + 1.5f, 7.5f);
+	const VisibilityStats sealed = updateVisibility(*flat, room);
+
+	for (int32_t x = 9; x < 16 * (g_benchTunnelChunks + 1) - 1; x++)
+	{
+		carveBenchBlock(*flat, roomChunk + glm::ivec3(x, g_benchRoomY + 1, 7));
+	}
+	for (int32_t i = 0; i <= g_benchTunnelChunks; i++)
+	{
+		linkChunkSections(flat->chunks.at(roomChunk + glm::ivec3(16 * i, 0, 0)));
+	}
+	const VisibilityStats tunnel = updateVisibility(*flat, room);
+
+	const uint32_t roomSection = g_benchRoomY / 16;
+	const std::array<uint8_t, 6>& tunnelLinks = flat->chunks.at(roomChunk + glm::ivec3(16, 0, 0)).links[roomSection];
+	const bool linked = tunnelLinks[static_cast<uint8_t>(SectionFace::RIGHT)] == (right | left) &&
+		tunnelLinks[static_cast<uint8_t>(SectionFace::TOP)] == 0;
+
+	// The same search on generated terrain, from above it and from deep inside the ground
+	std::unique_ptr<World> world = makeBenchWorld();
+	Player player;
+	initBenchPlayer(player);
+	world->shadowCascadeLevels = { player.camera.farPlane / 20.0f, player.camera.farPlane / 5.0f };
+
+	BenchClock::time_point start = BenchClock::now();
+	for (auto& pair : world->chunks)
+	{
+		linkChunkSections(pair.second);
+	}
+	const float linkMs = getElapsedMs(start) / world->chunks.size();
+
+	const VisibilityRun surface = runVisibility(*world, player);
+	player.camera.pos.y = 12.0f;
+	const VisibilityRun underground = runVisibility(*world, player);
+	world->cullOccluded = false;
+	const VisibilityRun unculled = runVisibility(*world, player);
+
+	const uint32_t chunks = g_chunksX * g_chunksZ;
+	const bool passed = open.chunks == chunks && sealed.chunks == 1 && sealed.sections == 1 && sealed.casters == 1 &&
+		tunnel.chunks == g_benchTunnelChunks + 1 && linked && underground.drawCalls < unculled.drawCalls;
+
+	std::cout
+		<< "visibility: " << chunks << " chunks, sections linked in " << linkMs << " ms/chunk\n"
+		<< "  flat        " << open.chunks << " chunks seen from the sky, " << sealed.chunks << " from a sealed room, "
+		<< tunnel.chunks << " through a tunnel out of it\n"
+		<< "  surface     " << surface.stats.chunks << " chunks, " << surface.stats.sections << " sections, "
+		<< surface.stats.casters << " casters in " << surface.ms << " ms, " << surface.drawCalls << " draw calls\n"
+		<< "  underground " << underground.stats.chunks << " chunks, " << underground.stats.sections << " sections, "
+		<< underground.stats.casters << " casters in " << underground.ms << " ms, " << underground.drawCalls
+		<< " draw calls, " << unculled.drawCalls << " without culling\n";
+
+	assert(passed);
+	return passed;
+}
+
+// Drives the staging ring like the renderer does, with fences that
+// signal a few frames later, and checks that live ranges never overlap
+bool benchStagingRing()
+{
+	using namespace Engine::Renderer;
+
+	struct Range
+	{
+		size_t begin;
+		size_t end;
+		uint32_t frame;
+	};
+
+	StagingRing ring;
+	initStagingRing(ring, g_benchRingSize);
+
+	std::vector<Range> live;
+	live.reserve(1024);
+
+	uint32_t reserved = 0;
+	uint32_t rejected = 0;
+	uint32_t random = 12345;
+	bool passed = true;
+
+	const BenchClock::time_point start = BenchClock::now();
+	for (uint32_t frame = 0; frame < g_benchRingFrames; frame++)
+	{
+		// Frame index stands in for the fence
+		while (StagingFrame* oldest = getOldestStagingFrame(ring))
+		{
+			const uint32_t fenceFrame = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(oldest->fence));
+			if (fenceFrame + g_framesInFlight > frame)
+			{
+				break;
+			}
+			releaseStagingFrame(ring);
+			live.erase(std::remove_if(live.begin(), live.end(),
+				[fenceFrame](const Range& range) { return range.frame == fenceFrame; }), live.end());
+		}
+
+		for (uint32_t upload = 0; upload < 8; upload++)
+		{
+			random = random * 1664525 + 1013904223;
+			const size_t bytes = (random >> 8) % (64 * 1024) + 4;
+
+			size_t offset;
+			if (!reserveStaging(ring, bytes, 4, offset))
+			{
+				rejected++;
+				continue;
+			}
+			reserved++;
+
+			for (const Range& range : live)
+			{
+				passed &= offset + bytes <= range.begin || offset >= range.end;
+			}
+			passed &= offset % 4 == 0 && offset + bytes <= g_benchRingSize;
+			live.push_back({ offset, offset + bytes, frame });
+		}
+
+		passed &= closeStagingFrame(ring, reinterpret_cast<void*>(static_cast<uintptr_t>(frame)));
+	}
+	const float elapsed = getElapsedMs(start);
+
+	std::cout
+		<< "staging ring: " << reserved << " reservations, " << rejected << " rejected while full, "
+		<< elapsed << " ms\n"
+		<< "  overlaps    " << (passed ? "none" : "FOUND") << "\n";
+
+	assert(passed);
+	return passed;
+}
+
+int32_t App::runBenchmarks()
+{
+	std::cout << std::fixed << std::setprecision(2);
+
+	bool passed = true;
+
+	benchChunkMemory();
+	passed &= benchSteadyFrames();
+	passed &= benchStagingRing();
+	passed &= benchCollision();
+	passed &= benchEntities();
+	passed &= benchFluids();
+	passed &= benchFallingBlocks();
+	passed &= benchBlockLight();
+	passed &= benchHeightMaps();
+	passed &= benchTerrainModes();
+	passed &= benchBiomes();
+	passed &= benchPopulation();
+	passed &= benchVisibility();
+
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
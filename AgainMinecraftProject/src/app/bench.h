@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace App
+{
+	// Headless benchmarks, GL work goes to the mock command backend
+	int32_t runBenchmarks();
+}
@@ -0,0 +1,145 @@
+/**
+* Job threads.
+*
+* Running jobs sit in a short list, a job thread takes the oldest one and
+* claims batches from it with an atomic counter until none are left. The
+* thread that started the job claims batches as well and only waits for the
+* batches already taken, so a job never stalls when every job thread is busy.
+*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../profiler/trace.h"
+
+#include "jobs.h"
+
+using namespace Engine;
+
+constexpr uint32_t g_maxRunningJobs = 64;
+
+static std::mutex g_jobMutex;
+static std::condition_variable g_jobAdded;
+static std::condition_variable g_jobLeft;
+static std::vector<Job*> g_runningJobs;
+static std::vector<std::thread> g_jobThreads;
+static bool g_jobsRunning = false;
+
+void runBatches(Job& job)
+{
+	while (true)
+	{
+		const uint32_t batch = job.next.fetch_add(1, std::memory_order_relaxed);
+		if (batch >= job.batches)
+		{
+			return;
+		}
+
+		TRACE_SCOPE(job.name);
+		const uint32_t begin = batch * job.batchSize;
+		job.run(job.context, begin, std::min(begin + job.batchSize, job.count));
+	}
+}
+
+// Called with the job mutex held, nothing can be claimed from the job anymore
+void removeRunningJob(Job& job)
+{
+	auto it = std::find(g_runningJobs.begin(), g_runningJobs.end(), &job);
+	if (it != g_runningJobs.end())
+	{
+		g_runningJobs.erase(it);
+	}
+}
+
+void jobThread()
+{
+	setTraceThreadName("jobs");
+
+	std::unique_lock<std::mutex> lock(g_jobMutex);
+	while (g_jobsRunning)
+	{
+		if (g_runningJobs.empty())
+		{
+			g_jobAdded.wait(lock);
+			continue;
+		}
+
+		Job& job = *g_runningJobs.front();
+		job.workers++;
+		lock.unlock();
+
+		runBatches(job);
+
+		lock.lock();
+		removeRunningJob(job);
+		if (--job.workers == 0)
+		{
+			g_jobLeft.notify_all();
+		}
+	}
+}
+
+void Engine::initJobs(uint32_t threads)
+{
+	std::lock_guard<std::mutex> lock(g_jobMutex);
+
+	g_runningJobs.reserve(g_maxRunningJobs);
+	g_jobsRunning = true;
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		g_jobThreads.push_back(std::thread(jobThread));
+	}
+}
+
+void Engine::shutdownJobs()
+{
+	{
+		std::lock_guard<std::mutex> lock(g_jobMutex);
+		g_jobsRunning = false;
+	}
+	g_jobAdded.notify_all();
+
+	for (std::thread& thread : g_jobThreads)
+	{
+		thread.join();
+	}
+	g_jobThreads.clear();
+}
+
+uint32_t Engine::getJobThreadCount()
+{
+	return static_cast<uint32_t>(g_jobThreads.size());
+}
+
+void Engine::runJob(Job& job)
+{
+	job.batches = (job.count + job.batchSize - 1) / job.batchSize;
+	job.workers = 0;
+	job.next.store(0, std::memory_order_relaxed);
+
+	// Not worth waking anyone for a single batch
+	const bool shared = !g_jobThreads.empty() && job.batches > 1;
+	if (shared)
+	{
+		{
+			std::lock_guard<std::mutex> lock(g_jobMutex);
+			if (g_runningJobs.size() < g_maxRunningJobs)
+			{
+				g_runningJobs.push_back(&job);
+			}
+		}
+		g_jobAdded.notify_all();
+	}
+
+	runBatches(job);
+
+	if (shared)
+	{
+		std::unique_lock<std::mutex> lock(g_jobMutex);
+		removeRunningJob(job);
+		g_jobLeft.wait(lock, [&job]() { return job.workers == 0; });
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+namespace Engine
+{
+	// A range of indices split into batches, the batches get claimed
+	// by the job threads and the thread that runs the job
+	struct Job
+	{
+		const char*				name;
+		void					(*run)(void* context, uint32_t begin, uint32_t end);
+		void*					context;
+		uint32_t				count;
+		uint32_t				batchSize;
+		uint32_t				batches;
+		uint32_t				workers; // Job threads inside the job, guarded by the job mutex
+		std::atomic<uint32_t>	next;
+	};
+
+	// Without job threads every job runs on the calling thread
+	void initJobs(uint32_t threads);
+	void shutdownJobs();
+	uint32_t getJobThreadCount();
+
+	// Returns once every batch ran, jobs may be started from inside other jobs
+	void runJob(Job& job);
+
+	// Calls fn(begin, end) for batches of [0, count), each batch is a trace span with the given name
+	template <typename F>
+	void parallelFor(const char* name, uint32_t count, uint32_t batchSize, F&& fn)
+	{
+		using Function = typename std::remove_reference<F>::type;
+
+		Job job;
+		job.name = name;
+		job.run = [](void* context, uint32_t begin, uint32_t end) {
+			(*static_cast<Function*>(context))(begin, end);
+		};
+		job.context = const_cast<void*>(static_cast<const void*>(&fn));
+		job.count = count;
+		job.batchSize = batchSize > 0 ? batchSize : 1;
+		runJob(job);
+	}
+}
@@ -0,0 +1,82 @@
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+#include "alloc_counter.h"
+
+static std::atomic<uint64_t> g_allocations = 0;
+static std::atomic<uint64_t> g_allocatedBytes = 0;
+
+uint64_t Engine::getAllocationCount()
+{
+	return g_allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t Engine::getAllocatedBytes()
+{
+	return g_allocatedBytes.load(std::memory_order_relaxed);
+}
+
+#ifdef TRACK_ALLOCATIONS
+void* countedAlloc(size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size)
+{
+	void* ptr = countedAlloc(size);
+	if (!ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+#endif
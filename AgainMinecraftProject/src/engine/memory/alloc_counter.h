@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+// Global new and delete get replaced by counting versions,
+// debug builds have it on by default
+#if defined(_DEBUG) && !defined(TRACK_ALLOCATIONS)
+#define TRACK_ALLOCATIONS
+#endif
+
+namespace Engine
+{
+	// Both stay at zero when allocations aren't tracked
+	uint64_t getAllocationCount();
+	uint64_t getAllocatedBytes();
+}
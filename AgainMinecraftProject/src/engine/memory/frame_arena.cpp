@@ -0,0 +1,33 @@
+#include <iostream>
+#include <stdlib.h>
+
+#include "frame_arena.h"
+
+void Engine::initFrameArena(FrameArena& arena, size_t size)
+{
+	arena.storage.resize(size);
+	arena.offset = 0;
+	arena.peak = 0;
+}
+
+void Engine::resetFrameArena(FrameArena& arena)
+{
+	arena.offset = 0;
+}
+
+void* Engine::allocateFrame(FrameArena& arena, size_t size, size_t alignment)
+{
+	const uintptr_t base = reinterpret_cast<uintptr_t>(arena.storage.data());
+	const size_t offset = ((base + arena.offset + alignment - 1) & ~(alignment - 1)) - base;
+
+	if (offset + size > arena.storage.size())
+	{
+		std::cout << "ERROR::FRAME_ARENA::OUT_OF_MEMORY::" << offset + size << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	arena.offset = offset + size;
+	arena.peak = std::max(arena.peak, arena.offset);
+
+	return arena.storage.data() + offset;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace Engine
+{
+	// Linear allocator for data that only lives until the end of the frame,
+	// everything gets released at once by resetting the offset
+	struct FrameArena
+	{
+		std::vector<uint8_t>	storage;
+		size_t					offset = 0;
+		size_t					peak = 0;
+	};
+
+	void initFrameArena(FrameArena& arena, size_t size);
+	void resetFrameArena(FrameArena& arena);
+	void* allocateFrame(FrameArena& arena, size_t size, size_t alignment);
+
+	template <typename T>
+	T* allocateFrame(FrameArena& arena, size_t count)
+	{
+		return static_cast<T*>(allocateFrame(arena, count * sizeof(T), alignof(T)));
+	}
+}
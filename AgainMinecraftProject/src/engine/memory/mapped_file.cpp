@@ -0,0 +1,94 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+bool Engine::mapFile(MappedFile& mapped, const char* path)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	HANDLE mapping = nullptr;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	}
+
+	const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!data)
+	{
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+
+	mapped.data = static_cast<const uint8_t*>(data);
+	mapped.size = static_cast<size_t>(size.QuadPart);
+	mapped.file = file;
+	mapped.mapping = mapping;
+	return true;
+}
+
+void Engine::unmapFile(MappedFile& mapped)
+{
+	if (mapped.data)
+	{
+		UnmapViewOfFile(mapped.data);
+		CloseHandle(mapped.mapping);
+		CloseHandle(mapped.file);
+	}
+	mapped = {};
+}
+#else
+bool Engine::mapFile(MappedFile& mapped, const char* path)
+{
+	const int32_t file = open(path, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	void* data = MAP_FAILED;
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	// The mapping stays valid after the descriptor is closed
+	close(file);
+
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	mapped.data = static_cast<const uint8_t*>(data);
+	mapped.size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+void Engine::unmapFile(MappedFile& mapped)
+{
+	if (mapped.data)
+	{
+		munmap(const_cast<uint8_t*>(mapped.data), mapped.size);
+	}
+	mapped = {};
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace Engine
+{
+	// Read only view of a whole file, pages are loaded by the OS on first access
+	struct MappedFile
+	{
+		const uint8_t*	data = nullptr;
+		size_t			size = 0;
+		void*			file = nullptr;
+		void*			mapping = nullptr;
+	};
+
+	bool mapFile(MappedFile& mapped, const char* path);
+	void unmapFile(MappedFile& mapped);
+}
@@ -1,5 +1,6 @@
 #include <glm/glm.hpp>
 #include <algorithm>
+#include <emmintrin.h>
 
 #include "noise.h"
 
@@ -13,7 +14,7 @@ using namespace Noise;
 #define TOKEN 0
 #ifdef TOKEN
 
-static constexpr uint32_t p[512] = {
+static constexpr uint32_t p[256] = {
    151, 160, 137, 91, 90, 15, 131, 13, 201, 95, 96, 53, 194, 233, 7, 225, 140, 36, 103, 30, 69, 142,
    8, 99, 37, 240, 21, 10, 23, 190, 6, 148, 247, 120, 234, 75, 0, 26, 197, 62, 94, 252, 219, 203,
    117, 35, 11, 32, 57, 177, 33, 88, 237, 149, 56, 87, 174, 20, 125, 136, 171, 168, 68, 175, 74,
@@ -29,6 +30,12 @@ static constexpr uint32_t p[512] = {
    78, 66, 215, 61, 156, 180,
 };
 
+// Wraps around the table, the lookups of the corners go past its end
+inline uint32_t perm(int32_t i)
+{
+	return p[i & 0xFF];
+}
+
 float Engine::Noise::perlin2D(float x, float y)
 {
 	auto lerp = [](float a0, float a1, float t) {
@@ -76,10 +83,10 @@ float Engine::Noise::perlin2D(float x, float y)
 	const float v = fade(yf0);
 
 	// Generate hash values for each point of the unit-square.
-	const int h00 = p[p[xi + 0] + yi + 0];
-	const int h01 = p[p[xi + 0] + yi + 1];
-	const int h10 = p[p[xi + 1] + yi + 0];
-	const int h11 = p[p[xi + 1] + yi + 1];
+	const int h00 = perm(perm(xi + 0) + yi + 0);
+	const int h01 = perm(perm(xi + 0) + yi + 1);
+	const int h10 = perm(perm(xi + 1) + yi + 0);
+	const int h11 = perm(perm(xi + 1) + yi + 1);
 
 	// Linearly interpolate between dot products of each gradient with its distance to the input location.
 	const float v1 = lerp(dot_grad(h00, xf0, yf0), dot_grad(h10, xf1, yf0), u);
@@ -145,14 +152,14 @@ float Engine::Noise::perlin3D(float x, float y, float z)
 	const float w = fade(zf0);
 
 	// Generate hash values for each point of the unit-square.
-	const int h000 = p[p[p[xi + 0] + yi + 0] + zi + 0];
-	const int h001 = p[p[p[xi + 0] + yi + 0] + zi + 1];
-	const int h010 = p[p[p[xi + 0] + yi + 1] + zi + 0];
-	const int h011 = p[p[p[xi + 0] + yi + 1] + zi + 1];
-	const int h100 = p[p[p[xi + 1] + yi + 0] + zi + 0];
-	const int h101 = p[p[p[xi + 1] + yi + 0] + zi + 1];
-	const int h110 = p[p[p[xi + 1] + yi + 1] + zi + 0];
-	const int h111 = p[p[p[xi + 1] + yi + 1] + zi + 1];
+	const int h000 = perm(perm(perm(xi + 0) + yi + 0) + zi + 0);
+	const int h001 = perm(perm(perm(xi + 0) + yi + 0) + zi + 1);
+	const int h010 = perm(perm(perm(xi + 0) + yi + 1) + zi + 0);
+	const int h011 = perm(perm(perm(xi + 0) + yi + 1) + zi + 1);
+	const int h100 = perm(perm(perm(xi + 1) + yi + 0) + zi + 0);
+	const int h101 = perm(perm(perm(xi + 1) + yi + 0) + zi + 1);
+	const int h110 = perm(perm(perm(xi + 1) + yi + 1) + zi + 0);
+	const int h111 = perm(perm(perm(xi + 1) + yi + 1) + zi + 1);
 
 	float x1, x2, y1, y2;
 
@@ -167,6 +174,133 @@ float Engine::Noise::perlin3D(float x, float y, float z)
 	return lerp(y1, y2, w);
 }
 
+// Truncation rounds negative values up, those lanes get one taken off
+inline __m128 floor4(__m128 x, __m128i& xi)
+{
+	const __m128i truncated = _mm_cvttps_epi32(x);
+	const __m128 above = _mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), x);
+	xi = _mm_add_epi32(truncated, _mm_castps_si128(above));
+	return _mm_sub_ps(_mm_cvtepi32_ps(truncated), _mm_and_ps(above, _mm_set1_ps(1.0f)));
+}
+
+inline __m128 select4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 fade4(__m128 t)
+{
+	const __m128 poly = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(6.0f), t), _mm_set1_ps(15.0f)), t), _mm_set1_ps(10.0f));
+	return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(poly, t), t), t);
+}
+
+inline __m128 lerp4(__m128 a, __m128 b, __m128 t)
+{
+	return _mm_add_ps(_mm_mul_ps(_mm_sub_ps(b, a), t), a);
+}
+
+// The gradients of the switch in perlin3D without branches, picked by comparing the low bits of the hash
+inline __m128 dotGrad4(__m128i hash, __m128 x, __m128 y, __m128 z)
+{
+	const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(0xF));
+	const __m128 useX = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+	const __m128 useY = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+	const __m128 otherX = _mm_castsi128_ps(_mm_or_si128(
+		_mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+
+	const __m128 u = select4(useX, x, y);
+	const __m128 v = select4(useY, y, select4(otherX, x, z));
+
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i two = _mm_set1_epi32(2);
+	const __m128 sign = _mm_set1_ps(-0.0f);
+	const __m128 uSign = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, one), one)), sign);
+	const __m128 vSign = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, two), two)), sign);
+	return _mm_add_ps(_mm_xor_ps(u, uSign), _mm_xor_ps(v, vSign));
+}
+
+// Four points at once, only the permutation lookups are done lane by lane
+__m128 perlin3D4(__m128 x, __m128 y, __m128 z)
+{
+	__m128i xi, yi, zi;
+	const __m128 xf0 = _mm_sub_ps(x, floor4(x, xi));
+	const __m128 yf0 = _mm_sub_ps(y, floor4(y, yi));
+	const __m128 zf0 = _mm_sub_ps(z, floor4(z, zi));
+	const __m128 xf1 = _mm_sub_ps(xf0, _mm_set1_ps(1.0f));
+	const __m128 yf1 = _mm_sub_ps(yf0, _mm_set1_ps(1.0f));
+	const __m128 zf1 = _mm_sub_ps(zf0, _mm_set1_ps(1.0f));
+
+	const __m128 u = fade4(xf0);
+	const __m128 v = fade4(yf0);
+	const __m128 w = fade4(zf0);
+
+	const __m128i wrap = _mm_set1_epi32(0xFF);
+	alignas(16) int32_t xs[4], ys[4], zs[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(xs), _mm_and_si128(xi, wrap));
+	_mm_store_si128(reinterpret_cast<__m128i*>(ys), _mm_and_si128(yi, wrap));
+	_mm_store_si128(reinterpret_cast<__m128i*>(zs), _mm_and_si128(zi, wrap));
+
+	// Corners by their x, y and z bits, the same lookups as perlin3D
+	int32_t h[8][4];
+	for (int32_t lane = 0; lane < 4; lane++)
+	{
+		const int32_t a = perm(xs[lane]) + ys[lane];
+		const int32_t b = perm(xs[lane] + 1) + ys[lane];
+		const int32_t zl = zs[lane];
+		h[0][lane] = perm(perm(a) + zl);
+		h[1][lane] = perm(perm(a) + zl + 1);
+		h[2][lane] = perm(perm(a + 1) + zl);
+		h[3][lane] = perm(perm(a + 1) + zl + 1);
+		h[4][lane] = perm(perm(b) + zl);
+		h[5][lane] = perm(perm(b) + zl + 1);
+		h[6][lane] = perm(perm(b + 1) + zl);
+		h[7][lane] = perm(perm(b + 1) + zl + 1);
+	}
+
+	auto corner = [&h](int32_t i) {
+		return _mm_set_epi32(h[i][3], h[i][2], h[i][1], h[i][0]);
+	};
+
+	const __m128 d000 = dotGrad4(corner(0), xf0, yf0, zf0);
+	const __m128 d001 = dotGrad4(corner(1), xf0, yf0, zf1);
+	const __m128 d010 = dotGrad4(corner(2), xf0, yf1, zf0);
+	const __m128 d011 = dotGrad4(corner(3), xf0, yf1, zf1);
+	const __m128 d100 = dotGrad4(corner(4), xf1, yf0, zf0);
+	const __m128 d101 = dotGrad4(corner(5), xf1, yf0, zf1);
+	const __m128 d110 = dotGrad4(corner(6), xf1, yf1, zf0);
+	const __m128 d111 = dotGrad4(corner(7), xf1, yf1, zf1);
+
+	const __m128 y0 = lerp4(lerp4(d000, d100, u), lerp4(d010, d110, u), v);
+	const __m128 y1 = lerp4(lerp4(d001, d101, u), lerp4(d011, d111, u), v);
+	return lerp4(y0, y1, w);
+}
+
+void Engine::Noise::perlin3D(const float* x, const float* y, const float* z, float* out, uint32_t count)
+{
+	uint32_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(out + i, perlin3D4(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i), _mm_loadu_ps(z + i)));
+	}
+
+	// The last points go through the same path, padded to four
+	if (i < count)
+	{
+		float tail[4][4] = {};
+		for (uint32_t j = 0; i + j < count; j++)
+		{
+			tail[0][j] = x[i + j];
+			tail[1][j] = y[i + j];
+			tail[2][j] = z[i + j];
+		}
+		_mm_storeu_ps(tail[3], perlin3D4(_mm_loadu_ps(tail[0]), _mm_loadu_ps(tail[1]), _mm_loadu_ps(tail[2])));
+		for (uint32_t j = 0; i + j < count; j++)
+		{
+			out[i + j] = tail[3][j];
+		}
+	}
+}
+
 
 float Engine::Noise::octavePerlin3D(const glm::vec3& pos, float persistence, int octaves)
 {
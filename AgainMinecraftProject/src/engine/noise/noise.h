@@ -1,11 +1,18 @@
 #pragma once
 
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
 namespace Engine
 {
 	namespace Noise
 	{
 		float perlin2D(float x, float y);
 		float perlin3D(float x, float y, float z);
+
+		// Same values as above for a batch of points, four at a time with SSE2
+		void perlin3D(const float* x, const float* y, const float* z, float* out, uint32_t count);
 		
 		float octavePerlin3D(const glm::vec3& pos, float persistence, int octaves);
 		float octavePerlin2D(const glm::vec3& pos, float persistence, int octaves);
@@ -0,0 +1,354 @@
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <cstdio>
+#include <iomanip>
+
+#include "profiler.h"
+
+using namespace Engine;
+
+struct GpuTimer
+{
+	uint32_t scope;
+	std::array<uint32_t, 2> queries;
+	std::array<bool, 2> pending;
+};
+
+static std::mutex g_profilerMutex;
+static std::vector<ProfileScope> g_scopes;
+static std::vector<GpuTimer> g_gpuTimers;
+static std::vector<ProfileCounter> g_counters;
+
+static std::array<float, g_profileHistory> g_frameTimes;
+static std::chrono::steady_clock::time_point g_frameStart;
+static uint64_t g_frameTraceStart = 0;
+static uint32_t g_cursor = 0;
+static uint32_t g_frames = 0;
+
+static bool g_gpuProfiling = false;
+static GpuTimer* g_activeGpuTimer = nullptr;
+
+// Parents of the currently open scopes of the thread
+static thread_local std::vector<uint32_t> t_scopeStack;
+
+uint32_t findScope(const char* name, uint32_t parent, bool gpu)
+{
+	for (uint32_t i = 0; i < g_scopes.size(); i++)
+	{
+		if (g_scopes[i].parent == parent && g_scopes[i].gpu == gpu &&
+			(g_scopes[i].name == name || std::strcmp(g_scopes[i].name, name) == 0))
+		{
+			return i;
+		}
+	}
+
+	ProfileScope scope = {};
+	scope.name = name;
+	scope.parent = parent;
+	scope.depth = parent == g_noScope ? 0 : g_scopes[parent].depth + 1;
+	scope.gpu = gpu;
+	g_scopes.push_back(scope);
+
+	return g_scopes.size() - 1;
+}
+
+void Engine::beginProfilerFrame()
+{
+	g_frameStart = std::chrono::steady_clock::now();
+	g_frameTraceStart = getTraceTime();
+}
+
+void Engine::endProfilerFrame()
+{
+	const std::chrono::duration<float, std::milli> frameTime = std::chrono::steady_clock::now() - g_frameStart;
+	if (isTracing())
+	{
+		addTraceSpan("frame", g_frameTraceStart, getTraceTime());
+	}
+
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+
+	if (g_gpuProfiling)
+	{
+		// Results of the previous frame, the ones recorded this frame are read next time
+		const uint32_t previous = (g_frames + 1) & 1;
+		for (auto& timer : g_gpuTimers)
+		{
+			if (!timer.pending[previous])
+			{
+				continue;
+			}
+
+			int32_t available = 0;
+			glGetQueryObjectiv(timer.queries[previous], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				uint64_t elapsed = 0;
+				glGetQueryObjectui64v(timer.queries[previous], GL_QUERY_RESULT, &elapsed);
+				g_scopes[timer.scope].current = elapsed / 1000000.0f;
+				timer.pending[previous] = false;
+			}
+		}
+	}
+
+	g_frameTimes[g_cursor] = frameTime.count();
+	for (auto& scope : g_scopes)
+	{
+		scope.samples[g_cursor] = scope.current;
+		scope.current = 0.0f;
+	}
+
+	g_cursor = (g_cursor + 1) % g_profileHistory;
+	g_frames++;
+}
+
+uint32_t Engine::beginProfileScope(const char* name)
+{
+	const uint32_t parent = t_scopeStack.empty() ? g_noScope : t_scopeStack.back();
+
+	uint32_t scope;
+	{
+		std::lock_guard<std::mutex> lock(g_profilerMutex);
+		scope = findScope(name, parent, false);
+	}
+
+	t_scopeStack.push_back(scope);
+	return scope;
+}
+
+void Engine::endProfileScope(uint32_t scope, float elapsed)
+{
+	t_scopeStack.pop_back();
+
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+	g_scopes[scope].current += elapsed;
+}
+
+void Engine::enableGpuProfiling()
+{
+	// Timer queries are core since 3.3
+	g_gpuProfiling = GLAD_GL_VERSION_3_3;
+}
+
+void Engine::beginGpuScope(const char* name)
+{
+	if (!g_gpuProfiling || g_activeGpuTimer)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+
+	const uint32_t parent = t_scopeStack.empty() ? g_noScope : t_scopeStack.back();
+	const uint32_t scope = findScope(name, parent, true);
+
+	auto it = std::find_if(g_gpuTimers.begin(), g_gpuTimers.end(),
+		[scope](const GpuTimer& timer) { return timer.scope == scope; });
+
+	if (it == g_gpuTimers.end())
+	{
+		GpuTimer timer = {};
+		timer.scope = scope;
+		glGenQueries(2, timer.queries.data());
+		g_gpuTimers.push_back(timer);
+		it = g_gpuTimers.end() - 1;
+	}
+
+	const uint32_t current = g_frames & 1;
+	if (it->pending[current])
+	{
+		// The result from two frames ago never arrived, it is dropped
+		uint64_t elapsed = 0;
+		glGetQueryObjectui64v(it->queries[current], GL_QUERY_RESULT, &elapsed);
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, it->queries[current]);
+	it->pending[current] = true;
+	g_activeGpuTimer = &*it;
+}
+
+void Engine::endGpuScope()
+{
+	if (!g_activeGpuTimer)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	g_activeGpuTimer = nullptr;
+}
+
+void Engine::setProfileCounter(const char* name, float value, float max)
+{
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+
+	auto it = std::find_if(g_counters.begin(), g_counters.end(),
+		[name](const ProfileCounter& counter) { return std::strcmp(counter.name, name) == 0; });
+
+	if (it == g_counters.end())
+	{
+		g_counters.push_back({ name, value, max });
+	}
+	else
+	{
+		it->value = value;
+		it->max = max;
+	}
+}
+
+ProfileStats computeStats(const std::array<float, g_profileHistory>& samples)
+{
+	const uint32_t count = std::min(g_frames, g_profileHistory);
+	if (!count)
+	{
+		return {};
+	}
+
+	std::array<float, g_profileHistory> sorted;
+	std::copy(samples.begin(), samples.begin() + count, sorted.begin());
+	std::sort(sorted.begin(), sorted.begin() + count);
+
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sum += sorted[i];
+	}
+
+	ProfileStats stats;
+	stats.average = sum / count;
+	stats.p50 = sorted[count * 50 / 100];
+	stats.p95 = sorted[count * 95 / 100];
+	stats.p99 = sorted[count * 99 / 100];
+	stats.max = sorted[count - 1];
+
+	return stats;
+}
+
+ProfileStats Engine::getProfileStats(uint32_t scope)
+{
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+	return computeStats(g_scopes[scope].samples);
+}
+
+ProfileStats Engine::getFrameStats()
+{
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+	return computeStats(g_frameTimes);
+}
+
+void Engine::getProfileScopes(std::vector<ProfileScope>& scopes)
+{
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+	scopes.assign(g_scopes.begin(), g_scopes.end());
+}
+
+void Engine::getProfileCounters(std::vector<ProfileCounter>& counters)
+{
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+	counters.assign(g_counters.begin(), g_counters.end());
+}
+
+std::array<float, g_profileHistory> Engine::getFrameTimes()
+{
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+	return g_frameTimes;
+}
+
+uint32_t Engine::getProfileCursor()
+{
+	return g_cursor;
+}
+
+const char* Engine::getProfileSummary()
+{
+	static std::array<char, 1024> summary;
+
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+
+	const ProfileStats frame = computeStats(g_frameTimes);
+	size_t length = std::snprintf(summary.data(), summary.size(), "frame %.2fms (p99 %.2f)", frame.average, frame.p99);
+
+	for (const auto& scope : g_scopes)
+	{
+		// Passes on the GPU are nested in their CPU scopes, but shown anyway
+		if ((scope.depth == 0 || scope.gpu) && length < summary.size())
+		{
+			length += std::snprintf(summary.data() + length, summary.size() - length, " | %s%s %.2f",
+				scope.gpu ? "gpu " : "", scope.name, computeStats(scope.samples).average);
+		}
+	}
+
+	for (const auto& counter : g_counters)
+	{
+		if (length < summary.size())
+		{
+			length += std::snprintf(summary.data() + length, summary.size() - length, " | %s %.2f",
+				counter.name, counter.value);
+		}
+	}
+
+	return summary.data();
+}
+
+void writeScopes(std::ofstream& file, uint32_t parent)
+{
+	for (uint32_t i = 0; i < g_scopes.size(); i++)
+	{
+		const ProfileScope& scope = g_scopes[i];
+		if (scope.parent != parent)
+		{
+			continue;
+		}
+
+		const ProfileStats stats = computeStats(scope.samples);
+		file
+			<< std::string(scope.depth * 2, ' ') << (scope.gpu ? "[gpu] " : "") << scope.name
+			<< " avg " << stats.average
+			<< " p50 " << stats.p50
+			<< " p95 " << stats.p95
+			<< " p99 " << stats.p99
+			<< " max " << stats.max << "\n";
+
+		writeScopes(file, i);
+	}
+}
+
+void Engine::dumpProfile(const char* path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "ERROR::PROFILER::FAILED_TO_OPEN::" << path << std::endl;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(g_profilerMutex);
+
+	file << std::fixed << std::setprecision(3);
+
+	const ProfileStats frame = computeStats(g_frameTimes);
+	file
+		<< "frames " << g_frames << ", last " << std::min(g_frames, g_profileHistory) << " in ms\n"
+		<< "frame avg " << frame.average
+		<< " p50 " << frame.p50
+		<< " p95 " << frame.p95
+		<< " p99 " << frame.p99
+		<< " max " << frame.max << "\n";
+
+	writeScopes(file, g_noScope);
+
+	for (const auto& counter : g_counters)
+	{
+		file << counter.name << " " << counter.value;
+		if (counter.max > 0.0f)
+		{
+			file << " / " << counter.max;
+		}
+		file << "\n";
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+#include <string>
+#include <chrono>
+
+#include "trace.h"
+
+namespace Engine
+{
+	constexpr uint32_t g_profileHistory = 240; // Frames kept for the graph and the percentiles
+	constexpr uint32_t g_noScope = 0xFFFFFFFF;
+
+	struct ProfileScope
+	{
+		const char*	name;
+		uint32_t	parent;
+		uint32_t	depth;
+		bool		gpu;
+		float		current; // Milliseconds accumulated during the frame
+
+		std::array<float, g_profileHistory> samples;
+	};
+
+	// Sampled values like memory usage, shown as bars when they have a max
+	struct ProfileCounter
+	{
+		const char*	name;
+		float		value;
+		float		max;
+	};
+
+	struct ProfileStats
+	{
+		float average;
+		float p50;
+		float p95;
+		float p99;
+		float max;
+	};
+
+	void beginProfilerFrame();
+	void endProfilerFrame();
+
+	uint32_t beginProfileScope(const char* name);
+	void endProfileScope(uint32_t scope, float elapsed);
+
+	// Timer queries of a frame are read back at the end of the next one,
+	// every GPU scope may be used once per frame and they can't be nested
+	void enableGpuProfiling();
+	void beginGpuScope(const char* name);
+	void endGpuScope();
+
+	void setProfileCounter(const char* name, float value, float max = 0.0f);
+
+	ProfileStats getProfileStats(uint32_t scope);
+	ProfileStats getFrameStats();
+
+	// Copies into the given vectors, so other threads can keep profiling
+	void getProfileScopes(std::vector<ProfileScope>& scopes);
+	void getProfileCounters(std::vector<ProfileCounter>& counters);
+	std::array<float, g_profileHistory> getFrameTimes();
+	uint32_t getProfileCursor();
+
+	// Written into a static buffer, so the title update doesn't allocate
+	const char* getProfileSummary();
+	void dumpProfile(const char* path);
+
+	struct ScopedTimer
+	{
+		ScopedTimer(const char* name)
+			: scope(beginProfileScope(name))
+			, start(std::chrono::steady_clock::now())
+			, trace(name)
+		{}
+
+		~ScopedTimer()
+		{
+			const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			endProfileScope(scope, elapsed.count());
+		}
+
+		uint32_t scope;
+		std::chrono::steady_clock::time_point start;
+		TraceScope trace;
+	};
+
+	struct ScopedGpuTimer
+	{
+		ScopedGpuTimer(const char* name)
+		{
+			beginGpuScope(name);
+		}
+
+		~ScopedGpuTimer()
+		{
+			endGpuScope();
+		}
+	};
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#define PROFILE_SCOPE(name) Engine::ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) Engine::ScopedGpuTimer PROFILE_CONCAT(profileGpuScope, __LINE__)(name)
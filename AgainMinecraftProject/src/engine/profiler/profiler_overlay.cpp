@@ -0,0 +1,120 @@
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "../shader/shader.h"
+
+#include "profiler.h"
+#include "profiler_overlay.h"
+
+using namespace Engine;
+
+constexpr uint32_t g_maxGraphLines = 6;
+constexpr uint32_t g_maxGraphBars = 4;
+constexpr float g_barSpacing = 0.02f;
+constexpr float g_graphScale = 1000.0f / 30.0f; // Full height is 30 fps
+
+// Bottom left corner of the screen in NDC
+constexpr glm::vec2 g_graphMin = { -0.98f, -0.98f };
+constexpr glm::vec2 g_graphSize = { 0.8f, 0.4f };
+
+static const glm::vec3 g_graphColors[g_maxGraphLines] = {
+	{ 1.0f, 1.0f, 1.0f },
+	{ 1.0f, 0.3f, 0.3f },
+	{ 0.3f, 1.0f, 0.3f },
+	{ 0.3f, 0.5f, 1.0f },
+	{ 1.0f, 1.0f, 0.3f },
+	{ 1.0f, 0.3f, 1.0f },
+};
+
+static uint32_t g_overlayVAO = 0;
+static uint32_t g_overlayVBO = 0;
+static std::vector<glm::vec2> g_graphPoints;
+static std::vector<ProfileScope> g_overlayScopes;
+static std::vector<ProfileCounter> g_overlayCounters;
+
+void addGraphLine(const std::array<float, g_profileHistory>& samples, uint32_t cursor)
+{
+	// Oldest sample on the left
+	for (uint32_t i = 0; i < g_profileHistory; i++)
+	{
+		const float value = samples[(cursor + i) % g_profileHistory] / g_graphScale;
+		g_graphPoints.push_back({
+			g_graphMin.x + g_graphSize.x * i / (g_profileHistory - 1),
+			g_graphMin.y + g_graphSize.y * glm::min(value, 1.0f) });
+	}
+}
+
+void Engine::initProfilerOverlay()
+{
+	g_graphPoints.reserve(g_maxGraphLines * g_profileHistory + 4 + 2 * g_maxGraphBars);
+
+	glGenVertexArrays(1, &g_overlayVAO);
+	glGenBuffers(1, &g_overlayVBO);
+
+	glBindVertexArray(g_overlayVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, g_overlayVBO);
+	glBufferData(GL_ARRAY_BUFFER, g_graphPoints.capacity() * sizeof(glm::vec2), nullptr, GL_DYNAMIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+}
+
+void Engine::drawProfilerOverlay(Shader& shader)
+{
+	const uint32_t cursor = getProfileCursor();
+	getProfileScopes(g_overlayScopes);
+	getProfileCounters(g_overlayCounters);
+
+	g_graphPoints.clear();
+
+	// 60 and 30 fps reference lines
+	g_graphPoints.push_back({ g_graphMin.x, g_graphMin.y + g_graphSize.y * 0.5f });
+	g_graphPoints.push_back({ g_graphMin.x + g_graphSize.x, g_graphMin.y + g_graphSize.y * 0.5f });
+	g_graphPoints.push_back({ g_graphMin.x, g_graphMin.y + g_graphSize.y });
+	g_graphPoints.push_back({ g_graphMin.x + g_graphSize.x, g_graphMin.y + g_graphSize.y });
+
+	addGraphLine(getFrameTimes(), cursor);
+
+	uint32_t lines = 1;
+	for (const auto& scope : g_overlayScopes)
+	{
+		if ((scope.depth == 0 || scope.gpu) && lines < g_maxGraphLines)
+		{
+			addGraphLine(scope.samples, cursor);
+			lines++;
+		}
+	}
+
+	// Counters with a known max are drawn as bars above the graph
+	uint32_t bars = 0;
+	for (const auto& counter : g_overlayCounters)
+	{
+		if (counter.max > 0.0f && bars < g_maxGraphBars)
+		{
+			const float y = g_graphMin.y + g_graphSize.y + g_barSpacing * (bars + 1);
+			g_graphPoints.push_back({ g_graphMin.x, y });
+			g_graphPoints.push_back({ g_graphMin.x + g_graphSize.x * glm::min(counter.value / counter.max, 1.0f), y });
+			bars++;
+		}
+	}
+
+	glBindVertexArray(g_overlayVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, g_overlayVBO);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, g_graphPoints.size() * sizeof(glm::vec2), g_graphPoints.data());
+
+	glDisable(GL_DEPTH_TEST);
+
+	setUniform3f(shader, Uniform::COLOR, glm::vec3(0.5f));
+	glDrawArrays(GL_LINES, 0, 4);
+
+	for (uint32_t line = 0; line < lines; line++)
+	{
+		setUniform3f(shader, Uniform::COLOR, g_graphColors[line]);
+		glDrawArrays(GL_LINE_STRIP, 4 + line * g_profileHistory, g_profileHistory);
+	}
+
+	setUniform3f(shader, Uniform::COLOR, glm::vec3(0.3f, 0.9f, 0.9f));
+	glDrawArrays(GL_LINES, 4 + lines * g_profileHistory, 2 * bars);
+
+	glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace Engine
+{
+	struct Shader;
+
+	// Rolling line graph of the frame and the top level scope times
+	void initProfilerOverlay();
+	void drawProfilerOverlay(Shader& shader);
+}
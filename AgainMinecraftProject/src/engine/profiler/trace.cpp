@@ -0,0 +1,161 @@
+/**
+* Every thread writes its spans into its own chain of fixed size blocks,
+* the only shared write is publishing the event count. Blocks are never
+* freed while tracing, so the writer can keep going while the trace is
+* being written out.
+*/
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include "trace.h"
+
+using namespace Engine;
+
+constexpr uint32_t g_traceBlockEvents = 4096;
+
+struct TraceEvent
+{
+	const char* name;
+	uint64_t	begin;
+	uint64_t	end;
+};
+
+struct TraceBlock
+{
+	TraceEvent				events[g_traceBlockEvents];
+	std::atomic<uint32_t>	count = 0;
+	std::atomic<TraceBlock*> next = nullptr;
+};
+
+struct TraceThread
+{
+	uint32_t				id;
+	std::atomic<const char*> name = nullptr;
+	TraceBlock				first;
+	TraceBlock*				current = &first;
+	std::atomic<TraceThread*> next = nullptr;
+};
+
+std::atomic<bool> Engine::g_tracing = false;
+
+static std::atomic<TraceThread*> g_traceThreads = nullptr;
+static std::atomic<uint32_t> g_traceThreadCount = 0;
+static std::mutex g_traceWriteMutex;
+
+static const std::chrono::steady_clock::time_point g_traceEpoch = std::chrono::steady_clock::now();
+
+static thread_local TraceThread* t_traceThread = nullptr;
+
+TraceThread* getTraceThread()
+{
+	if (!t_traceThread)
+	{
+		// Registered once per thread and kept for the rest of the run
+		TraceThread* thread = new TraceThread;
+		thread->id = g_traceThreadCount.fetch_add(1) + 1;
+
+		TraceThread* head = g_traceThreads.load();
+		do
+		{
+			thread->next = head;
+		} while (!g_traceThreads.compare_exchange_weak(head, thread));
+
+		t_traceThread = thread;
+	}
+
+	return t_traceThread;
+}
+
+void Engine::enableTracing(bool enabled)
+{
+	g_tracing.store(enabled);
+}
+
+void Engine::setTraceThreadName(const char* name)
+{
+	getTraceThread()->name = name;
+}
+
+uint64_t Engine::getTraceTime()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - g_traceEpoch).count();
+}
+
+void Engine::addTraceSpan(const char* name, uint64_t begin, uint64_t end)
+{
+	TraceThread* thread = getTraceThread();
+	TraceBlock* block = thread->current;
+
+	uint32_t count = block->count.load(std::memory_order_relaxed);
+	if (count == g_traceBlockEvents)
+	{
+		TraceBlock* next = new TraceBlock;
+		block->next.store(next, std::memory_order_release);
+		thread->current = next;
+		block = next;
+		count = 0;
+	}
+
+	block->events[count] = { name, begin, end };
+	block->count.store(count + 1, std::memory_order_release);
+}
+
+void Engine::writeTrace(const char* path)
+{
+	std::lock_guard<std::mutex> lock(g_traceWriteMutex);
+
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "ERROR::TRACE::FAILED_TO_OPEN::" << path << std::endl;
+		return;
+	}
+
+	file << "{\"traceEvents\":[\n";
+	bool first = true;
+
+	for (TraceThread* thread = g_traceThreads.load(); thread; thread = thread->next.load())
+	{
+		const char* name = thread->name.load();
+		if (name)
+		{
+			file << (first ? "" : ",\n")
+				<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+				<< ",\"args\":{\"name\":\"" << name << "\"}}";
+			first = false;
+		}
+
+		for (TraceBlock* block = &thread->first; block; block = block->next.load(std::memory_order_acquire))
+		{
+			const uint32_t count = block->count.load(std::memory_order_acquire);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const TraceEvent& event = block->events[i];
+				file << (first ? "" : ",\n")
+					<< "{\"name\":\"" << event.name
+					<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+					<< ",\"ts\":" << event.begin
+					<< ",\"dur\":" << event.end - event.begin << "}";
+				first = false;
+			}
+		}
+	}
+
+	file << "\n]}\n";
+}
+
+void Engine::clearTrace()
+{
+	// Only the counts get reset, blocks stay allocated for the next session
+	for (TraceThread* thread = g_traceThreads.load(); thread; thread = thread->next.load())
+	{
+		for (TraceBlock* block = &thread->first; block; block = block->next.load(std::memory_order_acquire))
+		{
+			block->count.store(0, std::memory_order_release);
+		}
+	}
+}
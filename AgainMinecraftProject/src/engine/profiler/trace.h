@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+namespace Engine
+{
+	extern std::atomic<bool> g_tracing;
+
+	// Spans are recorded only while tracing is enabled,
+	// otherwise a scope costs a single relaxed load
+	void enableTracing(bool enabled);
+	inline bool isTracing()
+	{
+		return g_tracing.load(std::memory_order_relaxed);
+	}
+
+	void setTraceThreadName(const char* name);
+
+	uint64_t getTraceTime(); // Microseconds since the first call
+	void addTraceSpan(const char* name, uint64_t begin, uint64_t end);
+
+	// Chrome trace event format, opens in chrome://tracing and Perfetto
+	void writeTrace(const char* path);
+	void clearTrace();
+
+	struct TraceScope
+	{
+		TraceScope(const char* name)
+			: name(isTracing() ? name : nullptr)
+			, begin(this->name ? getTraceTime() : 0)
+		{}
+
+		~TraceScope()
+		{
+			if (name)
+			{
+				addTraceSpan(name, begin, getTraceTime());
+			}
+		}
+
+		const char* name;
+		uint64_t begin;
+	};
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#define TRACE_SCOPE(name) Engine::TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
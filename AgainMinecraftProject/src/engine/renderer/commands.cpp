@@ -0,0 +1,438 @@
+/**
+* Render commands are recorded during the frame construction and
+* executed on submit. Before execution redundant state changes are
+* dropped, every submit starts with an unknown state since the code
+* around the passes still talks to GL directly.
+*/
+
+#include <glad/glad.h>
+
+#include "commands.h"
+#include "staging.h"
+
+using namespace Engine::Renderer;
+
+constexpr uint32_t g_unknownState = 0xFFFFFFFF;
+constexpr int32_t g_maxTextureUnits = 4;
+constexpr int32_t g_maxCachedUniforms = 32;
+
+static uint32_t g_mockObjects = 0;
+
+struct RenderState
+{
+	uint32_t framebuffer = g_unknownState;
+	uint32_t layer = g_unknownState;
+	uint32_t viewport = g_unknownState;
+	uint32_t culling = g_unknownState;
+	uint32_t program = g_unknownState;
+	uint32_t vao = g_unknownState;
+
+	std::array<uint32_t, g_maxTextureUnits> textures;
+
+	// Values of the current program uniforms
+	std::array<bool, g_maxCachedUniforms>		uniformSet;
+	std::array<glm::vec3, g_maxCachedUniforms>	uniforms;
+};
+
+void Engine::Renderer::beginCommands(CommandList& list)
+{
+	list.commands.clear();
+}
+
+void Engine::Renderer::resetCommandStats(CommandList& list)
+{
+	list.stats = {};
+	list.recorded.clear();
+}
+
+void Engine::Renderer::cmdBindFramebuffer(CommandList& list, uint32_t framebuffer)
+{
+	Command command = {};
+	command.type = CommandType::BIND_FRAMEBUFFER;
+	command.id = framebuffer;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdFramebufferLayer(CommandList& list, uint32_t texture, uint32_t layer)
+{
+	Command command = {};
+	command.type = CommandType::FRAMEBUFFER_LAYER;
+	command.id = texture;
+	command.count = layer;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdViewport(CommandList& list, uint32_t width, uint32_t height)
+{
+	Command command = {};
+	command.type = CommandType::VIEWPORT;
+	command.id = width;
+	command.count = height;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdClearDepth(CommandList& list)
+{
+	Command command = {};
+	command.type = CommandType::CLEAR_DEPTH;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdCulling(CommandList& list, bool enabled)
+{
+	Command command = {};
+	command.type = CommandType::CULLING;
+	command.id = enabled;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdUseProgram(CommandList& list, uint32_t program)
+{
+	Command command = {};
+	command.type = CommandType::USE_PROGRAM;
+	command.id = program;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdBindTextureArray(CommandList& list, uint32_t unit, uint32_t texture)
+{
+	Command command = {};
+	command.type = CommandType::BIND_TEXTURE_ARRAY;
+	command.location = unit;
+	command.id = texture;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdUniformi(CommandList& list, int32_t location, int32_t value)
+{
+	Command command = {};
+	command.type = CommandType::UNIFORM_1I;
+	command.location = location;
+	command.iValue = value;
+	command.fValue = glm::vec3(static_cast<float>(value));
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdUniform3f(CommandList& list, int32_t location, const glm::vec3& value)
+{
+	Command command = {};
+	command.type = CommandType::UNIFORM_3F;
+	command.location = location;
+	command.fValue = value;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdUpdateUBuffer(CommandList& list, UBuffer buffer, const void* data, uint32_t size)
+{
+	Command command = {};
+	command.type = CommandType::UPDATE_UBUFFER;
+	command.id = buffer;
+	command.data = data;
+	command.count = size;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdUpload(CommandList& list, MeshBuffer& buffer, const Mesh& mesh)
+{
+	Command command = {};
+	command.type = CommandType::UPLOAD;
+	command.buffer = &buffer;
+	command.mesh = &mesh;
+	list.commands.push_back(command);
+}
+
+void Engine::Renderer::cmdDraw(CommandList& list, MeshBuffer& buffer)
+{
+	Command command = {};
+	command.type = CommandType::DRAW;
+	command.buffer = &buffer;
+	list.commands.push_back(command);
+}
+
+bool isRedundant(RenderState& state, const Command& command)
+{
+	switch (command.type)
+	{
+	case CommandType::BIND_FRAMEBUFFER:
+		return state.framebuffer == command.id;
+
+	case CommandType::FRAMEBUFFER_LAYER:
+		return state.layer == command.count;
+
+	case CommandType::VIEWPORT:
+		return state.viewport == (command.id << 16 | command.count);
+
+	case CommandType::CULLING:
+		return state.culling == command.id;
+
+	case CommandType::USE_PROGRAM:
+		return state.program == command.id;
+
+	case CommandType::BIND_TEXTURE_ARRAY:
+		return
+			command.location >= 0 && command.location < g_maxTextureUnits &&
+			state.textures[command.location] == command.id;
+
+	case CommandType::UNIFORM_1I:
+	case CommandType::UNIFORM_3F:
+		return
+			command.location >= 0 && command.location < g_maxCachedUniforms &&
+			state.uniformSet[command.location] && state.uniforms[command.location] == command.fValue;
+
+	default:
+		return false;
+	}
+}
+
+void applyState(RenderState& state, const Command& command)
+{
+	switch (command.type)
+	{
+	case CommandType::BIND_FRAMEBUFFER:
+		state.framebuffer = command.id;
+		state.layer = g_unknownState;
+		break;
+
+	case CommandType::FRAMEBUFFER_LAYER:
+		state.layer = command.count;
+		break;
+
+	case CommandType::VIEWPORT:
+		state.viewport = command.id << 16 | command.count;
+		break;
+
+	case CommandType::CULLING:
+		state.culling = command.id;
+		break;
+
+	case CommandType::USE_PROGRAM:
+		state.program = command.id;
+		state.uniformSet.fill(false);
+		break;
+
+	case CommandType::BIND_TEXTURE_ARRAY:
+		if (command.location >= 0 && command.location < g_maxTextureUnits)
+		{
+			state.textures[command.location] = command.id;
+		}
+		break;
+
+	case CommandType::UNIFORM_1I:
+	case CommandType::UNIFORM_3F:
+		if (command.location >= 0 && command.location < g_maxCachedUniforms)
+		{
+			state.uniformSet[command.location] = true;
+			state.uniforms[command.location] = command.fValue;
+		}
+		break;
+
+	case CommandType::BIND_VAO:
+		state.vao = command.id;
+		break;
+
+	case CommandType::UPLOAD:
+		// Uploading binds the vertex array of the buffer
+		state.vao = command.buffer->VAO;
+		break;
+
+	default:
+		break;
+	}
+}
+
+void executeGL(CommandList& list, const Command& command)
+{
+	switch (command.type)
+	{
+	case CommandType::BIND_FRAMEBUFFER:
+		glBindFramebuffer(GL_FRAMEBUFFER, command.id);
+		break;
+
+	case CommandType::FRAMEBUFFER_LAYER:
+		glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, command.id, 0, command.count);
+		break;
+
+	case CommandType::VIEWPORT:
+		glViewport(0, 0, command.id, command.count);
+		break;
+
+	case CommandType::CLEAR_DEPTH:
+		glClear(GL_DEPTH_BUFFER_BIT);
+		break;
+
+	case CommandType::CULLING:
+		if (command.id)
+		{
+			glEnable(GL_CULL_FACE);
+		}
+		else
+		{
+			glDisable(GL_CULL_FACE);
+		}
+		break;
+
+	case CommandType::USE_PROGRAM:
+		glUseProgram(command.id);
+		break;
+
+	case CommandType::BIND_TEXTURE_ARRAY:
+		glActiveTexture(GL_TEXTURE0 + command.location);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, command.id);
+		break;
+
+	case CommandType::UNIFORM_1I:
+		glUniform1i(command.location, command.iValue);
+		break;
+
+	case CommandType::UNIFORM_3F:
+		glUniform3fv(command.location, 1, &command.fValue[0]);
+		break;
+
+	case CommandType::BIND_VAO:
+		glBindVertexArray(command.id);
+		break;
+
+	case CommandType::UPDATE_UBUFFER:
+		glBindBuffer(GL_UNIFORM_BUFFER, command.id);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, command.count, command.data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		break;
+
+	case CommandType::UPLOAD:
+		if (list.uploads)
+		{
+			uploadMesh(*list.uploads, *command.buffer, *command.mesh);
+		}
+		else
+		{
+			updateMesh(*command.buffer, *command.mesh);
+		}
+		break;
+
+	case CommandType::DRAW:
+		glDrawArrays(GL_TRIANGLES, 0, command.buffer->nVertices);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void executeMock(CommandList& list, const Command& command)
+{
+	if (command.type == CommandType::UPLOAD)
+	{
+		// Mock objects only need to be non zero and unique
+		if (!command.buffer->VAO)
+		{
+			command.buffer->VAO = ++g_mockObjects;
+			command.buffer->VBO = ++g_mockObjects;
+		}
+		command.buffer->nVertices = command.mesh->size();
+		command.buffer->bytes = command.mesh->size() * sizeof(Vertex);
+	}
+
+	list.recorded.push_back(command);
+}
+
+void execute(CommandList& list, RenderState& state, const Command& command)
+{
+	if (list.backend == Backend::GL)
+	{
+		executeGL(list, command);
+	}
+	else
+	{
+		executeMock(list, command);
+	}
+
+	applyState(state, command);
+	list.stats.executed[static_cast<size_t>(command.type)]++;
+
+	switch (command.type)
+	{
+	case CommandType::DRAW:
+		list.stats.drawCalls++;
+		list.stats.vertices += command.buffer->nVertices;
+		break;
+
+	case CommandType::UPLOAD:
+		list.stats.uploads++;
+		list.stats.uploadBytes += command.mesh->size() * sizeof(Vertex);
+		break;
+
+	case CommandType::UPDATE_UBUFFER:
+		list.stats.uploads++;
+		list.stats.uploadBytes += command.count;
+		break;
+
+	case CommandType::UNIFORM_1I:
+	case CommandType::UNIFORM_3F:
+		list.stats.uniforms++;
+		break;
+
+	case CommandType::CLEAR_DEPTH:
+		break;
+
+	default:
+		list.stats.stateChanges++;
+		break;
+	}
+}
+
+void Engine::Renderer::submitCommands(CommandList& list)
+{
+	RenderState state;
+	state.textures.fill(g_unknownState);
+	state.uniformSet.fill(false);
+
+	const bool staging = list.backend == Backend::GL && list.uploads;
+	bool staged = false;
+
+	for (const Command& command : list.commands)
+	{
+		list.stats.commands++;
+
+		// Staged copies have to land before anything can draw from them
+		if (staged && command.type != CommandType::UPLOAD)
+		{
+			flushUploads(*list.uploads);
+			state.vao = g_unknownState;
+			staged = false;
+		}
+		staged |= staging && command.type == CommandType::UPLOAD;
+
+		if (command.type == CommandType::DRAW)
+		{
+			// Vertex arrays get created on upload, so the binding is resolved here
+			if (!command.buffer->nVertices)
+			{
+				list.stats.filtered++;
+				continue;
+			}
+
+			if (state.vao != command.buffer->VAO)
+			{
+				Command bind = {};
+				bind.type = CommandType::BIND_VAO;
+				bind.id = command.buffer->VAO;
+				execute(list, state, bind);
+			}
+		}
+
+		if (isRedundant(state, command))
+		{
+			list.stats.filtered++;
+			continue;
+		}
+
+		execute(list, state, command);
+	}
+
+	if (staged)
+	{
+		flushUploads(*list.uploads);
+	}
+
+	list.commands.clear();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+
+namespace Engine
+{
+	namespace Renderer
+	{
+		// GL executes the commands, MOCK only records and counts them,
+		// so frames can be built and measured without a GPU
+		enum class Backend
+		{
+			GL,
+			MOCK
+		};
+
+		enum class CommandType : uint8_t
+		{
+			BIND_FRAMEBUFFER = 0,
+			FRAMEBUFFER_LAYER,
+			VIEWPORT,
+			CLEAR_DEPTH,
+			CULLING,
+			USE_PROGRAM,
+			BIND_TEXTURE_ARRAY,
+			UNIFORM_1I,
+			UNIFORM_3F,
+			BIND_VAO,
+			UPDATE_UBUFFER,
+			UPLOAD,
+			DRAW,
+			COUNT
+		};
+
+		struct Command
+		{
+			CommandType		type;
+			int32_t			location;	// Uniform location or texture unit
+			uint32_t		id;			// Framebuffer, texture, program or buffer
+			uint32_t		count;		// Layer, viewport height or bytes
+			int32_t			iValue;
+			glm::vec3		fValue;
+			const void*		data;
+			const Mesh*		mesh;
+			MeshBuffer*		buffer;
+		};
+
+		struct CommandStats
+		{
+			uint32_t	commands;
+			uint32_t	drawCalls;
+			uint32_t	vertices;
+			uint32_t	stateChanges;
+			uint32_t	uniforms;
+			uint32_t	filtered;	// Redundant commands dropped before execution
+			uint32_t	uploads;
+			size_t		uploadBytes;
+
+			std::array<uint32_t, static_cast<size_t>(CommandType::COUNT)> executed;
+		};
+
+		struct UploadManager;
+
+		struct CommandList
+		{
+			Backend					backend = Backend::GL;
+			UploadManager*			uploads = nullptr; // Meshes get staged when set, uploaded directly otherwise
+			std::vector<Command>	commands;
+			std::vector<Command>	recorded;	// Executed commands, only kept by the mock backend
+			CommandStats			stats = {};
+		};
+
+		void beginCommands(CommandList& list);
+		void submitCommands(CommandList& list);
+		void resetCommandStats(CommandList& list);
+
+		void cmdBindFramebuffer(CommandList& list, uint32_t framebuffer);
+		void cmdFramebufferLayer(CommandList& list, uint32_t texture, uint32_t layer);
+		void cmdViewport(CommandList& list, uint32_t width, uint32_t height);
+		void cmdClearDepth(CommandList& list);
+		void cmdCulling(CommandList& list, bool enabled);
+		void cmdUseProgram(CommandList& list, uint32_t program);
+		void cmdBindTextureArray(CommandList& list, uint32_t unit, uint32_t texture);
+		void cmdUniformi(CommandList& list, int32_t location, int32_t value);
+		void cmdUniform3f(CommandList& list, int32_t location, const glm::vec3& value);
+		void cmdUpdateUBuffer(CommandList& list, UBuffer buffer, const void* data, uint32_t size);
+		void cmdUpload(CommandList& list, MeshBuffer& buffer, const Mesh& mesh);
+		void cmdDraw(CommandList& list, MeshBuffer& buffer);
+	}
+}
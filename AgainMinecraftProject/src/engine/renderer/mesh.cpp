@@ -1,9 +1,14 @@
 #include <glad/glad.h>
+#include <atomic>
+
+#include "../profiler/profiler.h"
 
 #include "mesh.h"
 
 using namespace Engine::Renderer;
 
+static std::atomic<size_t> g_gpuBufferBytes = 0;
+
 void Engine::Renderer::initBuffer(MeshBuffer& buffer)
 {
 	glGenVertexArrays(1, &buffer.VAO);
@@ -21,8 +26,9 @@ void Engine::Renderer::initUBufferLM(UBuffer& uBuffer)
 {
 	glGenBuffers(1, &uBuffer);
 	glBindBuffer(GL_UNIFORM_BUFFER, uBuffer);
-	glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4x4) * 16, nullptr, GL_STATIC_DRAW);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, uBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4x4) * g_maxCascades, nullptr, GL_STATIC_DRAW);
+	g_gpuBufferBytes += sizeof(glm::mat4x4) * g_maxCascades;
+	glBindBufferBase(GL_UNIFORM_BUFFER, g_lightMatricesBinding, uBuffer);
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
@@ -41,6 +47,23 @@ void Engine::Renderer::updateUBufferLM(UBuffer& uBuffer, const std::vector<glm::
 	glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
+void Engine::Renderer::initUBufferFD(UBuffer& uBuffer)
+{
+	glGenBuffers(1, &uBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, uBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+	g_gpuBufferBytes += sizeof(FrameData);
+	glBindBufferBase(GL_UNIFORM_BUFFER, g_frameDataBinding, uBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Engine::Renderer::updateUBufferFD(UBuffer& uBuffer, const FrameData& frameData)
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, uBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &frameData);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 void Engine::Renderer::renderMesh(const MeshBuffer& buffer)
 {
 	glBindVertexArray(buffer.VAO);
@@ -57,6 +80,8 @@ void Engine::Renderer::renderMeshFaces(const MeshBuffer& buffer)
 
 void Engine::Renderer::updateMesh(MeshBuffer& buffer, const Mesh& mesh)
 {
+	PROFILE_SCOPE("uploadMesh");
+
 	if (!buffer.VAO)
 	{
 		initBuffer(buffer);
@@ -66,12 +91,182 @@ void Engine::Renderer::updateMesh(MeshBuffer& buffer, const Mesh& mesh)
 	glBindVertexArray(buffer.VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, buffer.VBO);
 	glBufferData(GL_ARRAY_BUFFER, mesh.size() * sizeof(Vertex), mesh.data(), GL_DYNAMIC_DRAW);
+
+	// glBufferData reallocates the storage to the exact size
+	g_gpuBufferBytes += mesh.size() * sizeof(Vertex);
+	g_gpuBufferBytes -= buffer.bytes;
+	buffer.bytes = mesh.size() * sizeof(Vertex);
+}
+
+void Engine::Renderer::reserveMesh(MeshBuffer& buffer, size_t bytes)
+{
+	if (!buffer.VAO)
+	{
+		initBuffer(buffer);
+	}
+
+	if (bytes > buffer.bytes)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer.VBO);
+		glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+
+		g_gpuBufferBytes += bytes - buffer.bytes;
+		buffer.bytes = bytes;
+	}
 }
 
 void Engine::Renderer::deleteMesh(MeshBuffer& mesh)
 {
 	glDeleteBuffers(1, &mesh.VBO);
 	glDeleteVertexArrays(1, &mesh.VAO);
+
+	g_gpuBufferBytes -= mesh.bytes;
+	mesh.bytes = 0;
+}
+
+size_t Engine::Renderer::getGpuBufferBytes()
+{
+	return g_gpuBufferBytes;
+}
+
+uint32_t getSizeClass(size_t bytes)
+{
+	uint32_t sizeClass = 0;
+	for (size_t classBytes = g_poolMinClassBytes; bytes >= classBytes && sizeClass < g_poolSizeClasses - 1; classBytes <<= 1)
+	{
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+void addFreeBuffer(BufferPool& pool, MeshBuffer& buffer)
+{
+	pool.freeLists[getSizeClass(buffer.bytes)].push_back(&buffer);
+	pool.nFree++;
+}
+
+MeshBuffer* takeFreeBuffer(BufferPool& pool, uint32_t sizeClass)
+{
+	MeshBuffer* buffer = pool.freeLists[sizeClass].back();
+	pool.freeLists[sizeClass].pop_back();
+	pool.nFree--;
+	return buffer;
+}
+
+void Engine::Renderer::initBufferPool(BufferPool& pool, uint32_t size)
+{
+	pool.buffers.resize(size);
+	pool.retired.reserve(size);
+	for (auto& freeList : pool.freeLists)
+	{
+		freeList.reserve(size);
+	}
+
+	for (auto& buffer : pool.buffers)
+	{
+		buffer = {};
+		addFreeBuffer(pool, buffer);
+	}
+}
+
+MeshBuffer* Engine::Renderer::acquireBuffer(BufferPool& pool, size_t bytes)
+{
+	if (!pool.nFree)
+	{
+		return nullptr;
+	}
+
+	const uint32_t sizeClass = getSizeClass(bytes);
+	MeshBuffer* buffer = nullptr;
+
+	// Its own class may hold a buffer big enough, any buffer above it is
+	if (!pool.freeLists[sizeClass].empty() && pool.freeLists[sizeClass].back()->bytes >= bytes)
+	{
+		buffer = takeFreeBuffer(pool, sizeClass);
+	}
+
+	for (uint32_t i = sizeClass + 1; !buffer && i < g_poolSizeClasses; i++)
+	{
+		if (!pool.freeLists[i].empty())
+		{
+			buffer = takeFreeBuffer(pool, i);
+		}
+	}
+
+	// Otherwise the biggest smaller one, it grows on upload
+	for (int32_t i = sizeClass; !buffer && i >= 0; i--)
+	{
+		if (!pool.freeLists[i].empty())
+		{
+			buffer = takeFreeBuffer(pool, i);
+		}
+	}
+
+	buffer->active = true;
+	pool.activeCounter++;
+
+	return buffer;
+}
+
+void Engine::Renderer::releaseBuffer(BufferPool& pool, MeshBuffer& buffer)
+{
+	buffer.active = false;
+	buffer.nVertices = 0;
+	pool.activeCounter--;
+	pool.retired.push_back({ &buffer, pool.frame });
+}
+
+void Engine::Renderer::fenceBufferPool(BufferPool& pool)
+{
+	if (!pool.retired.empty() && pool.retired.back().frame == pool.frame)
+	{
+		void*& fence = pool.fences[pool.frame % g_poolFences];
+		if (fence)
+		{
+			// Ran out of fence slots, the oldest one has to finish first, recycling deletes it
+			glClientWaitSync(static_cast<GLsync>(fence), GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+			recycleBufferPool(pool);
+		}
+
+		if (fence)
+		{
+			// Still not done, the buffers of this frame stay pending under the fence of the next one
+			for (auto it = pool.retired.rbegin(); it != pool.retired.rend() && it->frame == pool.frame; ++it)
+			{
+				it->frame++;
+			}
+		}
+		else
+		{
+			fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+	}
+	pool.frame++;
+}
+
+void Engine::Renderer::recycleBufferPool(BufferPool& pool)
+{
+	for (; pool.completedFrame < pool.frame; pool.completedFrame++)
+	{
+		void*& fence = pool.fences[pool.completedFrame % g_poolFences];
+		if (fence)
+		{
+			if (glClientWaitSync(static_cast<GLsync>(fence), 0, 0) == GL_TIMEOUT_EXPIRED)
+			{
+				break;
+			}
+			glDeleteSync(static_cast<GLsync>(fence));
+			fence = nullptr;
+		}
+	}
+
+	// Retired buffers are ordered by frame
+	uint32_t recycled = 0;
+	for (; recycled < pool.retired.size() && pool.retired[recycled].frame < pool.completedFrame; recycled++)
+	{
+		addFreeBuffer(pool, *pool.retired[recycled].buffer);
+	}
+	pool.retired.erase(pool.retired.begin(), pool.retired.begin() + recycled);
 }
 
 
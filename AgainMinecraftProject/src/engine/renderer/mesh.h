@@ -13,8 +13,8 @@ namespace Engine
 		struct Vertex
 		{
 			// x : 5 bits, y: 9 bits, z : 5 bits (19 bits)
-			// coordInd : 2 bits, texId : 4 bits (6 bits)
-			// Total 25 bits
+			// coordInd : 2 bits, texId : 4 bits, normalId : 2 bits (8 bits)
+			// block light : 4 bits, from bit 28
 			int32_t data;
 		};
 		using Mesh = std::vector<Vertex>;
@@ -26,28 +26,76 @@ namespace Engine
 			uint32_t VAO;
 			uint32_t VBO;
 
+			size_t bytes = 0; // Size of the vertex storage on the GPU
+
 			bool active = false;
 		};
 
-		template<uint32_t N>
+		constexpr uint32_t g_poolSizeClasses = 12;
+		constexpr size_t g_poolMinClassBytes = 4 * 1024;
+		constexpr uint32_t g_poolFences = 8;
+
+		struct RetiredBuffer
+		{
+			MeshBuffer*	buffer;
+			uint64_t	frame;
+		};
+
+		// Buffers keep their storage between chunks, free ones are bucketed by
+		// capacity. Released buffers wait for the fence of their frame before reuse
 		struct BufferPool
 		{
-			std::array<MeshBuffer, N> buffers;
+			std::vector<MeshBuffer> buffers; // Never resized after init, chunks point into it
 			uint32_t activeCounter = 0;
+
+			std::array<std::vector<MeshBuffer*>, g_poolSizeClasses> freeLists;
+			uint32_t nFree = 0;
+
+			std::vector<RetiredBuffer> retired;
+			std::array<void*, g_poolFences> fences = {};
+			uint64_t frame = 0;
+			uint64_t completedFrame = 0;
 		};
 
 		using UBuffer = uint32_t;
 
+		constexpr uint32_t g_maxCascades = 16;
+		constexpr uint32_t g_lightMatricesBinding = 0;
+		constexpr uint32_t g_frameDataBinding = 1;
+
+		// Mirrors the std140 FrameData block in the shaders
+		struct alignas(16) FrameData
+		{
+			glm::mat4 projection;
+			glm::mat4 view;
+			glm::vec4 lightDir;
+			glm::vec4 cascadePlaneDistances[g_maxCascades]; // std140 pads array elements to 16 bytes
+			float farPlane;
+			int32_t cascadeCount;
+		};
+
 		void initBuffer(MeshBuffer& buffer);
 		void updateMesh(MeshBuffer& buffer, const Mesh& mesh);
+		void reserveMesh(MeshBuffer& buffer, size_t bytes); // Grows the storage, contents are undefined after
 		void renderMesh(const MeshBuffer& buffer);
 		void renderMeshFaces(const MeshBuffer& buffer);
 		void deleteMesh(MeshBuffer& buffer);
 
+		size_t getGpuBufferBytes();
+
+		void initBufferPool(BufferPool& pool, uint32_t size);
+		MeshBuffer* acquireBuffer(BufferPool& pool, size_t bytes);
+		void releaseBuffer(BufferPool& pool, MeshBuffer& buffer);
+		void fenceBufferPool(BufferPool& pool);		// After the last draw of the frame
+		void recycleBufferPool(BufferPool& pool);
+
 		void initUBufferLM(UBuffer& buffer);
 		void useUBufferLM(UBuffer& buffer);
 		void updateUBufferLM(UBuffer& buffer, const std::vector<glm::mat4>& lightMatrices);
 
+		void initUBufferFD(UBuffer& buffer);
+		void updateUBufferFD(UBuffer& buffer, const FrameData& frameData);
+
 		void enableCulling();
 		void disableCulling();
 	}
@@ -0,0 +1,234 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+
+#include "../profiler/profiler.h"
+
+#include "staging.h"
+
+using namespace Engine::Renderer;
+
+void Engine::Renderer::initStagingRing(StagingRing& ring, size_t size)
+{
+	ring = {};
+	ring.size = size;
+}
+
+bool Engine::Renderer::reserveStaging(StagingRing& ring, size_t bytes, size_t alignment, size_t& offset)
+{
+	size_t start = (ring.head + alignment - 1) / alignment * alignment;
+	size_t padding = start - ring.head;
+
+	// Allocations never wrap around, the end of the ring gets skipped instead
+	if (start + bytes > ring.size)
+	{
+		start = 0;
+		padding = ring.size - ring.head;
+	}
+
+	if (ring.used + padding + bytes > ring.size)
+	{
+		return false;
+	}
+
+	ring.head = start + bytes;
+	ring.used += padding + bytes;
+	ring.frameBytes += padding + bytes;
+	offset = start;
+
+	return true;
+}
+
+bool Engine::Renderer::closeStagingFrame(StagingRing& ring, void* fence)
+{
+	if (ring.nFrames == g_maxStagingFrames)
+	{
+		return false;
+	}
+
+	ring.frames[(ring.firstFrame + ring.nFrames) % g_maxStagingFrames] = { ring.frameBytes, fence };
+	ring.nFrames++;
+	ring.frameBytes = 0;
+
+	return true;
+}
+
+StagingFrame* Engine::Renderer::getOldestStagingFrame(StagingRing& ring)
+{
+	return ring.nFrames ? &ring.frames[ring.firstFrame] : nullptr;
+}
+
+void Engine::Renderer::releaseStagingFrame(StagingRing& ring)
+{
+	ring.used -= ring.frames[ring.firstFrame].bytes;
+	ring.firstFrame = (ring.firstFrame + 1) % g_maxStagingFrames;
+	ring.nFrames--;
+}
+
+void Engine::Renderer::initUploadManager(UploadManager& uploads, size_t size)
+{
+	initStagingRing(uploads.ring, size);
+	uploads.copies.reserve(1024);
+
+	glGenBuffers(1, &uploads.buffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, uploads.buffer);
+
+	uploads.persistent = GLAD_GL_VERSION_4_4 && glBufferStorage;
+	if (uploads.persistent)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_READ_BUFFER, size, nullptr, flags);
+		uploads.mapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags));
+	}
+	else
+	{
+		glBufferData(GL_COPY_READ_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		uploads.fallback.resize(size);
+		uploads.mapped = uploads.fallback.data();
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+// Expects the upload mutex to be locked
+void retireUploads(UploadManager& uploads, bool wait)
+{
+	while (StagingFrame* frame = getOldestStagingFrame(uploads.ring))
+	{
+		if (frame->fence)
+		{
+			const GLsync fence = static_cast<GLsync>(frame->fence);
+			const GLuint64 timeout = wait ? 1000000000 : 0;
+			const GLenum result = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+			if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+			{
+				break;
+			}
+			glDeleteSync(fence);
+		}
+		releaseStagingFrame(uploads.ring);
+		wait = false;
+	}
+}
+
+Vertex* Engine::Renderer::reserveUpload(UploadManager& uploads, uint32_t nVertices, size_t& offset)
+{
+	std::lock_guard<std::mutex> lock(uploads.mutex);
+
+	if (!reserveStaging(uploads.ring, nVertices * sizeof(Vertex), sizeof(Vertex), offset))
+	{
+		return nullptr;
+	}
+	return reinterpret_cast<Vertex*>(uploads.mapped + offset);
+}
+
+void Engine::Renderer::queueUpload(UploadManager& uploads, MeshBuffer& buffer, size_t offset, uint32_t nVertices)
+{
+	std::lock_guard<std::mutex> lock(uploads.mutex);
+	uploads.copies.push_back({ &buffer, offset, nVertices });
+}
+
+// An older copy still queued for the buffer would overwrite what gets written right away
+void dropPendingUploads(UploadManager& uploads, const MeshBuffer& buffer)
+{
+	std::lock_guard<std::mutex> lock(uploads.mutex);
+	uploads.copies.erase(
+		std::remove_if(uploads.copies.begin(), uploads.copies.end(),
+			[&buffer](const auto& copy) { return copy.buffer == &buffer; }),
+		uploads.copies.end());
+}
+
+void Engine::Renderer::uploadMesh(UploadManager& uploads, MeshBuffer& buffer, const Mesh& mesh)
+{
+	if (mesh.empty())
+	{
+		dropPendingUploads(uploads, buffer);
+		buffer.nVertices = 0;
+		return;
+	}
+
+	size_t offset;
+	Vertex* staging = reserveUpload(uploads, mesh.size(), offset);
+	if (!staging)
+	{
+		// Old frames may have finished in the meantime
+		{
+			std::lock_guard<std::mutex> lock(uploads.mutex);
+			retireUploads(uploads, false);
+		}
+		staging = reserveUpload(uploads, mesh.size(), offset);
+	}
+
+	if (!staging)
+	{
+		dropPendingUploads(uploads, buffer);
+		updateMesh(buffer, mesh);
+		uploads.stats.direct++;
+		return;
+	}
+
+	std::memcpy(staging, mesh.data(), mesh.size() * sizeof(Vertex));
+	queueUpload(uploads, buffer, offset, mesh.size());
+	uploads.stats.staged++;
+	uploads.stats.stagedBytes += mesh.size() * sizeof(Vertex);
+}
+
+bool Engine::Renderer::hasPendingUploads(UploadManager& uploads)
+{
+	std::lock_guard<std::mutex> lock(uploads.mutex);
+	return !uploads.copies.empty();
+}
+
+void Engine::Renderer::flushUploads(UploadManager& uploads)
+{
+	PROFILE_SCOPE("flushUploads");
+
+	std::lock_guard<std::mutex> lock(uploads.mutex);
+
+	if (uploads.copies.empty())
+	{
+		return;
+	}
+
+	glBindBuffer(GL_COPY_READ_BUFFER, uploads.buffer);
+
+	if (!uploads.persistent)
+	{
+		// Orphaning gives a fresh storage, so the GPU never waits for the previous copies
+		glBufferData(GL_COPY_READ_BUFFER, uploads.ring.size, nullptr, GL_STREAM_DRAW);
+		for (const auto& copy : uploads.copies)
+		{
+			glBufferSubData(GL_COPY_READ_BUFFER, copy.offset, copy.nVertices * sizeof(Vertex), uploads.mapped + copy.offset);
+		}
+	}
+
+	for (const auto& copy : uploads.copies)
+	{
+		const size_t bytes = copy.nVertices * sizeof(Vertex);
+		reserveMesh(*copy.buffer, bytes);
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, copy.buffer->VBO);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copy.offset, 0, bytes);
+		copy.buffer->nVertices = copy.nVertices;
+	}
+	uploads.copies.clear();
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	// The fallback memory was already copied by glBufferSubData, only mapped memory has to be fenced
+	void* fence = uploads.persistent ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+	if (!closeStagingFrame(uploads.ring, fence))
+	{
+		retireUploads(uploads, true);
+		uploads.stats.waits++;
+		if (!closeStagingFrame(uploads.ring, fence) && fence)
+		{
+			// Still no free frame, its bytes stay in the open frame and the fence of the next flush covers them
+			glDeleteSync(static_cast<GLsync>(fence));
+		}
+	}
+	uploads.stats.flushes++;
+
+	retireUploads(uploads, false);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "mesh.h"
+
+namespace Engine
+{
+	namespace Renderer
+	{
+		constexpr uint32_t g_maxStagingFrames = 32;
+
+		// Staged bytes of one flush, released once its fence is signaled
+		struct StagingFrame
+		{
+			size_t	bytes;
+			void*	fence;
+		};
+
+		// Ring allocator over the staging memory, doesn't touch GL
+		struct StagingRing
+		{
+			size_t		size = 0;
+			size_t		head = 0;
+			size_t		used = 0;		// Includes the padding skipped at wraps
+			size_t		frameBytes = 0;	// Reserved since the last closed frame
+
+			std::array<StagingFrame, g_maxStagingFrames> frames;
+			uint32_t	firstFrame = 0;
+			uint32_t	nFrames = 0;
+		};
+
+		void initStagingRing(StagingRing& ring, size_t size);
+		bool reserveStaging(StagingRing& ring, size_t bytes, size_t alignment, size_t& offset);
+		bool closeStagingFrame(StagingRing& ring, void* fence);
+		StagingFrame* getOldestStagingFrame(StagingRing& ring);
+		void releaseStagingFrame(StagingRing& ring);
+
+		struct StagedCopy
+		{
+			MeshBuffer*	buffer;
+			size_t		offset;
+			uint32_t	nVertices;
+		};
+
+		struct UploadStats
+		{
+			uint32_t	staged;
+			uint32_t	direct;		// Ring was full, uploaded with glBufferData
+			uint32_t	flushes;
+			uint32_t	waits;		// Ran out of frames and had to block on a fence
+			size_t		stagedBytes;
+		};
+
+		// Persistently mapped staging buffer when buffer storage is available,
+		// otherwise a CPU copy that gets orphaned into the buffer on flush
+		struct UploadManager
+		{
+			StagingRing				ring;
+			uint32_t				buffer = 0;
+			uint8_t*				mapped = nullptr;
+			bool					persistent = false;
+			std::vector<uint8_t>	fallback;
+
+			std::mutex				mutex;	// Workers may reserve and write staging memory
+			std::vector<StagedCopy>	copies;
+			UploadStats				stats = {};
+		};
+
+		void initUploadManager(UploadManager& uploads, size_t size);
+
+		// Reserved memory can be written from any thread, the copy into
+		// the mesh buffer is queued once the vertices are written
+		Vertex* reserveUpload(UploadManager& uploads, uint32_t nVertices, size_t& offset);
+		void queueUpload(UploadManager& uploads, MeshBuffer& buffer, size_t offset, uint32_t nVertices);
+
+		void uploadMesh(UploadManager& uploads, MeshBuffer& buffer, const Mesh& mesh);
+		bool hasPendingUploads(UploadManager& uploads);
+
+		// Main thread only, issues the queued copies and fences them
+		void flushUploads(UploadManager& uploads);
+	}
+}
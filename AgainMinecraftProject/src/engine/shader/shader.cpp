@@ -6,11 +6,35 @@
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "../renderer/mesh.h"
+
 #include "shader_list.h"
 #include "shader.h"
 
 using namespace Engine;
 
+static_assert(sizeof(s_uniformNames) / sizeof(s_uniformNames[0]) == static_cast<size_t>(Uniform::COUNT));
+
+void bindUniformBlock(Shader& shader, const char* block, uint32_t binding)
+{
+	uint32_t index = glGetUniformBlockIndex(shader.id, block);
+	if (index != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(shader.id, index, binding);
+	}
+}
+
+void resolveUniforms(Shader& shader)
+{
+	for (uint32_t i = 0; i < shader.locations.size(); i++)
+	{
+		shader.locations[i] = glGetUniformLocation(shader.id, s_uniformNames[i]);
+	}
+
+	bindUniformBlock(shader, "LightSpaceMatrices", Renderer::g_lightMatricesBinding);
+	bindUniformBlock(shader, "FrameData", Renderer::g_frameDataBinding);
+}
+
 void Engine::loadShaders(std::map<const char*, Shader>& shaders)
 {
 	for (auto& el : s_shaderPaths)
@@ -107,6 +131,8 @@ void Engine::initShader(Shader& shader, const char* vPath, const char* fPath)
 		exit(EXIT_FAILURE);
 	}
 
+	resolveUniforms(shader);
+
 	glDeleteShader(vID);
 	glDeleteShader(fID);
 }
@@ -205,6 +231,8 @@ void Engine::initShader(Shader& shader, const char* vPath, const char* gPath, co
 		exit(EXIT_FAILURE);
 	}
 
+	resolveUniforms(shader);
+
 	glDeleteShader(vID);
 	glDeleteShader(gID);
 	glDeleteShader(fID);
@@ -254,3 +282,37 @@ void Engine::setUniformBool(Shader& shader, const char* uniform, bool value)
 	useShader(shader);
 	glUniform1i(getAndCheckUniformLocation(shader, uniform), value);
 }
+
+int32_t getAndCheckUniformLocation(Shader& shader, Uniform uniform)
+{
+	int32_t location = shader.locations[static_cast<size_t>(uniform)];
+	if (location == -1)
+	{
+		std::cout << "ERROR::UNIFORM::UNIFORM_NOT_FOUND:" << s_uniformNames[static_cast<size_t>(uniform)] << std::endl;
+	}
+	return location;
+}
+
+void Engine::setUniformi(Shader& shader, Uniform uniform, int32_t value)
+{
+	useShader(shader);
+	glUniform1i(getAndCheckUniformLocation(shader, uniform), value);
+}
+
+void Engine::setUniformf(Shader& shader, Uniform uniform, float value)
+{
+	useShader(shader);
+	glUniform1f(getAndCheckUniformLocation(shader, uniform), value);
+}
+
+void Engine::setUniform3f(Shader& shader, Uniform uniform, const glm::vec3& vec)
+{
+	useShader(shader);
+	glUniform3fv(getAndCheckUniformLocation(shader, uniform), 1, &vec[0]);
+}
+
+void Engine::setUniformBool(Shader& shader, Uniform uniform, bool value)
+{
+	useShader(shader);
+	glUniform1i(getAndCheckUniformLocation(shader, uniform), value);
+}
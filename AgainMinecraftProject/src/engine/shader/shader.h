@@ -1,14 +1,31 @@
 #pragma once
 
 #include <map>
+#include <array>
 
 #include <glm/glm.hpp>
 
 namespace Engine
 {
+	// Uniforms whose locations get resolved once the program is linked,
+	// per-frame constants live in the FrameData uniform block instead
+	enum class Uniform : uint8_t
+	{
+		CHUNK_POS = 0,
+		LAYER,
+		POSITION,
+		TEXTURE_ARRAY,
+		SHADOW_MAP,
+		SHOW_CASCADES,
+		DEPTH_MAP,
+		COLOR,
+		COUNT
+	};
+
 	struct Shader
 	{
 		size_t id;
+		std::array<int32_t, static_cast<size_t>(Uniform::COUNT)> locations;
 	};
 
 	void loadShaders(std::map<const char*, Shader>& shaders);
@@ -21,4 +38,14 @@ namespace Engine
 	void setUniformf(Shader& shader, const char* uniform, float value);
 	void setUniform3f(Shader& shader, const char* uniform, const glm::vec3& vec);
 	void setUniform4m(Shader& shader, const char* uniform, const glm::mat4& mat);
+
+	void setUniformBool(Shader& shader, Uniform uniform, bool value);
+	void setUniformi(Shader& shader, Uniform uniform, int32_t value);
+	void setUniformf(Shader& shader, Uniform uniform, float value);
+	void setUniform3f(Shader& shader, Uniform uniform, const glm::vec3& vec);
+
+	inline int32_t getLocation(const Shader& shader, Uniform uniform)
+	{
+		return shader.locations[static_cast<size_t>(uniform)];
+	}
 }
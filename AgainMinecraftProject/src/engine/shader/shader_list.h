@@ -13,10 +13,24 @@ namespace Engine
 		static const char* s_meshAndShadow = "mesh_shadow";
 		static const char* s_shadowDepth = "shadow_depth";
 		static const char* s_cascadedDepth = "shadow_cascaded_depth";
+		static const char* s_cascadeLayerDepth = "shadow_cascade_layer_depth";
 		static const char* s_lightObj = "light_obj";
 		static const char* s_debugQuad = "debug_quad";
+		static const char* s_profilerGraph = "profiler_graph";
 	}
 
+	// Indexed by Engine::Uniform
+	static const char* s_uniformNames[] = {
+		"u_chunkPos",
+		"u_layer",
+		"u_position",
+		"u_textureArray",
+		"u_shadowMap",
+		"u_showCascades",
+		"u_depthMap",
+		"u_color",
+	};
+
 	using ShaderProgram = std::pair<const char*, const char*>;
 	using ShaderProgramExtended = std::vector<const char*>;
 
@@ -27,8 +41,10 @@ namespace Engine
 		{ShadersAvailable::s_outlineShader,		{"shaders/face_outline_shader.vs",	"shaders/face_outline_shader.fs"}},
 		{ShadersAvailable::s_meshAndShadow,		{"shaders/mesh_shadow_mapping.vs",	"shaders/mesh_shadow_mapping.fs"}},
 		{ShadersAvailable::s_shadowDepth,		{"shaders/shadow_mapping_depth.vs",	"shaders/shadow_mapping_depth.fs"}},
+		{ShadersAvailable::s_cascadeLayerDepth,	{"shaders/shadow_cascade_layer_depth.vs",	"shaders/shadow_mapping_depth.fs"}},
 		{ShadersAvailable::s_lightObj,			{"shaders/light_obj.vs",			"shaders/light_obj.fs"}},
 		{ShadersAvailable::s_debugQuad,			{"shaders/debug_quad.vs",			"shaders/debug_quad.fs"}},
+		{ShadersAvailable::s_profilerGraph,		{"shaders/profiler_graph.vs",		"shaders/profiler_graph.fs"}},
 	};
 
 	static const std::map<const char*, ShaderProgramExtended> s_extendedShaderPaths = {
@@ -60,7 +60,7 @@ void Engine::initFArrayBuffer(FBuffer& fBuffer, const std::vector<float>& cascad
 		GL_DEPTH_COMPONENT32F,
 		g_shadowResolution,
 		g_shadowResolution,
-		cascades.size() + 1,
+		cascades.size(), // Past the last split the world shader falls back to the baked skylight
 		0,
 		GL_DEPTH_COMPONENT,
 		GL_FLOAT,
@@ -103,6 +103,11 @@ void Engine::bindFBuffer(FBuffer& fBuffer)
 	//glFramebufferTexture(GL_FRAMEBUFFER, GL_TEXTURE_2D_ARRAY, fBuffer.map, 0);
 }
 
+void Engine::bindFBufferLayer(FBuffer& fBuffer, uint32_t layer)
+{
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, fBuffer.map, 0, layer);
+}
+
 void Engine::unbindFBuffer() 
 {
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -19,6 +19,7 @@ namespace Engine
 	void initFBuffer(FBuffer& fBuffer);
 	void initFArrayBuffer(FBuffer& fBuffer, const std::vector<float>& cascades);
 	void bindFBuffer(FBuffer& fBuffer);
+	void bindFBufferLayer(FBuffer& fBuffer, uint32_t layer);
 	void useFArray(FBuffer& buffer);
 	void unbindFBuffer();
 	void setFramebufferViewport();
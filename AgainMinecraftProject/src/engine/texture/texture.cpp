@@ -1,8 +1,15 @@
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <future>
+#include <algorithm>
+#include <cstring>
+#include <sys/stat.h>
 
 #include <glad/glad.h>
 
+#include "../profiler/trace.h"
+
 #include "stb_loader.h"
 #include "texture.h"
 
@@ -41,53 +48,301 @@ bool Engine::initTexture(Texture& texture, const char* path)
 	return false;
 }
 
-bool Engine::initTextureArray(TextureArray& tArray, const std::vector<const char*>& paths)
+// Cache layout: the header, then the pixels of every level
+struct TextureCacheHeader
 {
-	glGenTextures(1, &tArray.id);
-	glBindTexture(GL_TEXTURE_2D_ARRAY, tArray.id);
+	uint32_t	magic;
+	uint32_t	version;
+	uint64_t	stamp;
+	int32_t		width;
+	int32_t		height;
+	int32_t		layers;
+	int32_t		levels;
+};
+
+constexpr uint32_t g_textureCacheMagic = 0x41585456; // VTXA
+constexpr uint32_t g_textureCacheVersion = 1;
+constexpr int32_t g_textureChannels = 4;
+constexpr int32_t g_maxTextureLevels = 32; // Levels of a cache beyond that can't be real
+
+struct DecodedImage
+{
+	unsigned char*	pixels;
+	int32_t			width;
+	int32_t			height;
+	int32_t			channels;
+};
+
+// Changes when an image is edited, replaced or the list is reordered
+uint64_t getTextureStamp(const std::vector<const char*>& paths)
+{
+	uint64_t stamp = 0xcbf29ce484222325;
+	auto mix = [&stamp](uint64_t value) {
+		stamp = (stamp ^ value) * 0x100000001b3;
+	};
+
+	for (const char* path : paths)
+	{
+		for (const char* c = path; *c; c++)
+		{
+			mix(*c);
+		}
+
+		struct stat info;
+		if (stat(path, &info) == 0)
+		{
+			mix(static_cast<uint64_t>(info.st_mtime));
+			mix(static_cast<uint64_t>(info.st_size));
+		}
+	}
+	return stamp;
+}
+
+size_t getLevelBytes(const TextureArrayData& data, int32_t level)
+{
+	const size_t width = std::max(data.width >> level, 1);
+	const size_t height = std::max(data.height >> level, 1);
+	return width * height * data.layers * g_textureChannels;
+}
+
+size_t getTextureArrayBytes(const TextureArrayData& data)
+{
+	size_t bytes = 0;
+	for (int32_t level = 0; level < data.levels; level++)
+	{
+		bytes += getLevelBytes(data, level);
+	}
+	return bytes;
+}
 
-	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, 64, 64, paths.size());
-	for (uint8_t index = 0; index < paths.size(); index++)
+// Box filters every level from the previous one
+void buildMipChain(TextureArrayData& data)
+{
+	uint8_t* src = data.decoded.data();
+	for (int32_t level = 1; level < data.levels; level++)
 	{
-		stbi_set_flip_vertically_on_load(true);
-		unsigned char* data = stbi_load(paths[index], &tArray.width, &tArray.height, &tArray.nrChannels, 0);
+		const int32_t srcWidth = std::max(data.width >> (level - 1), 1);
+		const int32_t srcHeight = std::max(data.height >> (level - 1), 1);
+		const int32_t width = std::max(data.width >> level, 1);
+		const int32_t height = std::max(data.height >> level, 1);
 
-		if (!data)
+		uint8_t* dst = src + getLevelBytes(data, level - 1);
+		for (int32_t layer = 0; layer < data.layers; layer++)
 		{
-			std::cout << "Could not upload data." << std::endl;
-			exit(EXIT_FAILURE);
+			const uint8_t* srcLayer = src + layer * srcWidth * srcHeight * g_textureChannels;
+			uint8_t* dstLayer = dst + layer * width * height * g_textureChannels;
+
+			for (int32_t y = 0; y < height; y++)
+			{
+				const int32_t y0 = std::min(2 * y, srcHeight - 1);
+				const int32_t y1 = std::min(2 * y + 1, srcHeight - 1);
+				for (int32_t x = 0; x < width; x++)
+				{
+					const int32_t x0 = std::min(2 * x, srcWidth - 1);
+					const int32_t x1 = std::min(2 * x + 1, srcWidth - 1);
+					for (int32_t channel = 0; channel < g_textureChannels; channel++)
+					{
+						const uint32_t sum =
+							srcLayer[(y0 * srcWidth + x0) * g_textureChannels + channel] +
+							srcLayer[(y0 * srcWidth + x1) * g_textureChannels + channel] +
+							srcLayer[(y1 * srcWidth + x0) * g_textureChannels + channel] +
+							srcLayer[(y1 * srcWidth + x1) * g_textureChannels + channel];
+						dstLayer[(y * width + x) * g_textureChannels + channel] = static_cast<uint8_t>((sum + 2) / 4);
+					}
+				}
+			}
 		}
+		src = dst;
+	}
+}
+
+bool readTextureCache(TextureArrayData& data, const char* cachePath, uint64_t stamp)
+{
+	if (!cachePath || !mapFile(data.cache, cachePath))
+	{
+		return false;
+	}
+
+	TextureCacheHeader header = {};
+	if (data.cache.size >= sizeof(header))
+	{
+		std::memcpy(&header, data.cache.data, sizeof(header));
+	}
+
+	// The sizes only get trusted once the header is known to be one of ours
+	const bool valid =
+		header.magic == g_textureCacheMagic &&
+		header.version == g_textureCacheVersion &&
+		header.stamp == stamp &&
+		header.levels <= g_maxTextureLevels;
+	if (valid)
+	{
+		data.width = header.width;
+		data.height = header.height;
+		data.layers = header.layers;
+		data.levels = header.levels;
+		data.bytes = getTextureArrayBytes(data);
+	}
+
+	if (!valid || data.cache.size != sizeof(header) + data.bytes)
+	{
+		unmapFile(data.cache);
+		data = {};
+		return false;
+	}
+
+	data.pixels = data.cache.data + sizeof(header);
+	data.fromCache = true;
+	return true;
+}
+
+void writeTextureCache(const TextureArrayData& data, const char* cachePath, uint64_t stamp)
+{
+	TextureCacheHeader header = {
+		g_textureCacheMagic, g_textureCacheVersion, stamp,
+		data.width, data.height, data.layers, data.levels };
+
+	std::ofstream file(cachePath, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(data.pixels), data.bytes);
+
+	if (!file)
+	{
+		std::cout << "ERROR::TEXTURE::CACHE::NOT_WRITTEN::" << cachePath << std::endl;
+	}
+}
+
+bool Engine::loadTextureArrayData(TextureArrayData& data, const std::vector<const char*>& paths, const char* cachePath)
+{
+	TRACE_SCOPE("loadTextures");
+
+	const uint64_t stamp = getTextureStamp(paths);
+	if (readTextureCache(data, cachePath, stamp))
+	{
+		return true;
+	}
 
-		uint32_t transparency;
+	stbi_set_flip_vertically_on_load(true);
 
-		if (std::string(paths[index]).find(".jpg") != std::string::npos && data)
+	std::vector<std::future<DecodedImage>> images;
+	images.reserve(paths.size());
+	for (const char* path : paths)
+	{
+		images.push_back(std::async(std::launch::async, [path]() {
+			TRACE_SCOPE("decodeTexture");
+			DecodedImage image = {};
+			// Jpgs get an opaque alpha, every layer ends up RGBA
+			image.pixels = stbi_load(path, &image.width, &image.height, &image.channels, g_textureChannels);
+			return image;
+		}));
+	}
+
+	bool decoded = true;
+	for (uint32_t layer = 0; layer < images.size(); layer++)
+	{
+		const DecodedImage image = images[layer].get();
+		if (layer == 0)
 		{
-			transparency = GL_RGB;
+			data.width = image.width;
+			data.height = image.height;
+			data.layers = images.size();
+			data.levels = 1;
+			while (std::max(data.width, data.height) >> data.levels)
+			{
+				data.levels++;
+			}
+			data.bytes = getTextureArrayBytes(data);
+			data.decoded.resize(data.bytes);
+		}
+
+		if (!image.pixels || image.width != data.width || image.height != data.height)
+		{
+			std::cout << "ERROR::TEXTURE::DECODE::" << paths[layer] << std::endl;
+			decoded = false;
 		}
 		else
 		{
-			transparency = GL_RGBA;
+			const size_t layerBytes = data.width * data.height * g_textureChannels;
+			std::memcpy(data.decoded.data() + layer * layerBytes, image.pixels, layerBytes);
 		}
+		stbi_image_free(image.pixels);
+	}
+
+	if (!decoded)
+	{
+		exit(EXIT_FAILURE);
+	}
 
+	buildMipChain(data);
+	data.pixels = data.decoded.data();
+
+	if (cachePath)
+	{
+		writeTextureCache(data, cachePath, stamp);
+	}
+
+	return true;
+}
+
+void Engine::releaseTextureArrayData(TextureArrayData& data)
+{
+	unmapFile(data.cache);
+	data = {};
+}
+
+bool Engine::initTextureArray(TextureArray& tArray, const std::vector<const char*>& paths)
+{
+	TextureArrayData data;
+	loadTextureArrayData(data, paths, nullptr);
+	initTextureArray(tArray, data);
+	releaseTextureArrayData(data);
+	return true;
+}
+
+bool Engine::initTextureArray(TextureArray& tArray, const TextureArrayData& data)
+{
+	tArray.width = data.width;
+	tArray.height = data.height;
+	tArray.nrChannels = g_textureChannels;
+
+	glGenTextures(1, &tArray.id);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, tArray.id);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, data.levels, GL_RGBA8, data.width, data.height, data.layers);
+
+	// The whole chain reaches the driver in one copy, every level is read from its offset
+	uint32_t pixelBuffer;
+	glGenBuffers(1, &pixelBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, data.bytes, data.pixels, GL_STREAM_DRAW);
+
+	size_t offset = 0;
+	for (int32_t level = 0; level < data.levels; level++)
+	{
 		glTexSubImage3D(
 			GL_TEXTURE_2D_ARRAY,
+			level,
 			0,
 			0,
 			0,
-			index,
-			tArray.width,
-			tArray.height,
-			1,
-			transparency,
+			std::max(data.width >> level, 1),
+			std::max(data.height >> level, 1),
+			data.layers,
+			GL_RGBA,
 			GL_UNSIGNED_BYTE,
-			data);
-		stbi_image_free(data);
+			reinterpret_cast<const void*>(offset));
+		offset += getLevelBytes(data, level);
 	}
 
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glDeleteBuffers(1, &pixelBuffer);
+
 	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, data.levels - 1);
+
+	return true;
 }
 
 void Engine::useTextureArray(TextureArray& tArray)
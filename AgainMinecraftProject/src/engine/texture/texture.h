@@ -2,6 +2,8 @@
 
 #include <vector>
 
+#include "../memory/mapped_file.h"
+
 namespace Engine
 {
 	struct Texture
@@ -12,8 +14,28 @@ namespace Engine
 
 	using TextureArray = Texture;
 
+	// RGBA8 layers with their whole mip chain, level after level,
+	// either decoded from the images or mapped from the cache
+	struct TextureArrayData
+	{
+		int32_t					width = 0;
+		int32_t					height = 0;
+		int32_t					layers = 0;
+		int32_t					levels = 0;
+		const uint8_t*			pixels = nullptr;
+		size_t					bytes = 0;
+		std::vector<uint8_t>	decoded;
+		MappedFile				cache;
+		bool					fromCache = false;
+	};
+
 	bool initTexture(Texture& texture, const char* path);
 	bool initTextureArray(TextureArray& texture, const std::vector<const char*>& paths);
+	bool initTextureArray(TextureArray& texture, const TextureArrayData& data);
+
+	// Needs no GL context, so it can run on a worker thread
+	bool loadTextureArrayData(TextureArrayData& data, const std::vector<const char*>& paths, const char* cachePath);
+	void releaseTextureArrayData(TextureArrayData& data);
 
 	void useTexture(Texture& texture);
 	void useTextureArray(TextureArray& array);
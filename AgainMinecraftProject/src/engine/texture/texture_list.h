@@ -13,7 +13,9 @@ namespace Engine
 		"textures/sand.png",		//  4
 		"textures/snow.png",		//  5
 		"textures/water.png",		//  6
-		//"textures/leaf.png",		//  7
+		"textures/snow_2.png",		//  7
+		"textures/leaf.png",		//  8
+		"textures/log.png",			//  9
 	};
 
 	enum class TextureId : uint8_t
@@ -24,6 +26,9 @@ namespace Engine
 		STONE,
 		SAND,
 		SNOW,
-		WATER
+		WATER,
+		LAMP,
+		LEAVES,
+		LOG
 	};
 }
\ No newline at end of file
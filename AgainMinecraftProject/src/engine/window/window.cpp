@@ -69,3 +69,8 @@ void Engine::updateScreen(GLFWwindow* window)
 	glfwSwapBuffers(window);
 	glfwPollEvents();
 }
+
+void Engine::setVSync(bool enabled)
+{
+	glfwSwapInterval(enabled ? 1 : 0);
+}
@@ -11,6 +11,7 @@ namespace Engine
 	void		clearDepthBuff();
 	void		setViewport(const size_t width, const size_t height);
 	void		updateScreen(GLFWwindow* window);
+	void		setVSync(bool enabled);
 	void		enableCulling();
 	void		disableCulling();
 }
@@ -17,11 +17,44 @@
 * - Having nice water, transperency, but I need to add some color change when underwater.
 */
 
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
 #include "app/app.h"
+#include "app/bench.h"
+#include "engine/profiler/trace.h"
+#include "engine/window/window.h"
 
 int main(int argc, char **argv)
 {
+	float tickRate = 60.0f;
+	bool vSync = true;
+
+	// Traces the startup as well, written to trace.json on exit
+	for (int32_t i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--trace") == 0)
+		{
+			Engine::enableTracing(true);
+		}
+		else if (std::strcmp(argv[i], "--bench") == 0)
+		{
+			return App::runBenchmarks();
+		}
+		else if (std::strcmp(argv[i], "--tick") == 0 && i + 1 < argc)
+		{
+			tickRate = std::max(static_cast<float>(std::atof(argv[++i])), 1.0f);
+		}
+		else if (std::strcmp(argv[i], "--novsync") == 0)
+		{
+			vSync = false;
+		}
+	}
+
 	App::Application* app = new App::Application;
+	app->setTickRate(tickRate);
+	Engine::setVSync(vSync);
 	app->run();
 	delete app;
 
@@ -0,0 +1,255 @@
+/**
+* Biomes.
+*
+* Temperature and humidity are 2D noise that changes over hundreds of blocks,
+* so they are only sampled every few blocks, for a whole region at once. The
+* regions are cached and shared by all of their chunks, a column interpolates
+* its climate from the samples around it. Every biome sits at a point of the
+* climate, a column blends the biomes by how close their climate is to its
+* own, so heights change smoothly from one biome into the next.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <FastNoiseLite.h>
+
+#include "biome.h"
+
+using namespace GameModule;
+
+constexpr int32_t g_chunkWidth = 16;
+constexpr int32_t g_regionWidth = 8 * g_chunkWidth;
+constexpr int32_t g_climateStep = 8; // Blocks between two samples
+constexpr int32_t g_climateSamples = g_regionWidth / g_climateStep + 1;
+constexpr uint32_t g_maxClimateTiles = 64;
+
+constexpr float g_climateFrequency = 0.004f;
+constexpr float g_biomeSpread = 0.04f; // Squared climate distance over which neighbouring biomes blend
+
+struct Biome
+{
+	BiomeType	type;
+	float		temperature;
+	float		humidity;
+	float		heightOffset;
+	float		heightScale;
+	float		stoneLevel;
+	float		snowLevel;
+	BlockType	surface;
+	BlockType	filler;
+	float		trees;
+};
+
+// Mountains keep the recipe all terrain had before there were biomes
+static const Biome g_biomes[] = {
+	{ BiomeType::PLAINS,	0.6f,	0.4f,	92.0f,	90.0f,	255.0f,	255.0f,	BlockType::GRASS,	BlockType::DIRT,	0.04f },
+	{ BiomeType::FOREST,	0.5f,	0.8f,	88.0f,	140.0f,	170.0f,	185.0f,	BlockType::GRASS,	BlockType::DIRT,	0.6f },
+	{ BiomeType::DESERT,	0.9f,	0.1f,	96.0f,	60.0f,	255.0f,	255.0f,	BlockType::SAND,	BlockType::SAND,	0.0f },
+	{ BiomeType::MOUNTAINS,	0.3f,	0.5f,	80.0f,	200.0f,	155.0f,	160.0f,	BlockType::GRASS,	BlockType::DIRT,	0.08f },
+	{ BiomeType::TUNDRA,	0.0f,	0.4f,	90.0f,	120.0f,	165.0f,	150.0f,	BlockType::SNOW,	BlockType::DIRT,	0.1f },
+};
+
+constexpr uint32_t g_biomeCount = sizeof(g_biomes) / sizeof(g_biomes[0]);
+
+// Temperature and humidity in [0, 1] at every sample of a region, the last row and column are
+// the first ones of the next region, so the columns at the border interpolate like any other
+struct ClimateTile
+{
+	std::array<glm::vec2, g_climateSamples * g_climateSamples> climate;
+};
+
+struct CachedTile
+{
+	std::shared_ptr<const ClimateTile>	tile;
+	uint64_t							lastUse;
+};
+
+static std::mutex g_climateMutex;
+static std::unordered_map<uint64_t, CachedTile> g_climateTiles;
+static uint64_t g_climateUses = 0;
+static ClimateCacheStats g_climateStats = {};
+
+FastNoiseLite makeClimateNoise(int32_t seed)
+{
+	FastNoiseLite noise;
+	noise.SetSeed(seed);
+	noise.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
+	noise.SetFractalType(FastNoiseLite::FractalType_FBm);
+	noise.SetFractalOctaves(2);
+	noise.SetFrequency(g_climateFrequency);
+	return noise;
+}
+
+// Only read once built, generation threads share them
+static const FastNoiseLite g_temperatureNoise = makeClimateNoise(1701);
+static const FastNoiseLite g_humidityNoise = makeClimateNoise(2903);
+
+inline int32_t floorDiv(int32_t a, int32_t b)
+{
+	return a >= 0 ? a / b : (a - b + 1) / b;
+}
+
+inline uint64_t getTileKey(int32_t x, int32_t z)
+{
+	return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(z);
+}
+
+std::shared_ptr<const ClimateTile> buildClimateTile(int32_t originX, int32_t originZ)
+{
+	std::shared_ptr<ClimateTile> tile = std::make_shared<ClimateTile>();
+	for (int32_t z = 0; z < g_climateSamples; z++)
+	{
+		for (int32_t x = 0; x < g_climateSamples; x++)
+		{
+			const float worldX = static_cast<float>(originX + x * g_climateStep);
+			const float worldZ = static_cast<float>(originZ + z * g_climateStep);
+			tile->climate[g_climateSamples * z + x] = {
+				g_temperatureNoise.GetNoise(worldX, worldZ) * 0.5f + 0.5f,
+				g_humidityNoise.GetNoise(worldX, worldZ) * 0.5f + 0.5f };
+		}
+	}
+	return tile;
+}
+
+// Built outside of the lock, a thread that loses the race to another one drops its copy
+std::shared_ptr<const ClimateTile> getClimateTile(int32_t originX, int32_t originZ)
+{
+	const uint64_t key = getTileKey(originX, originZ);
+	{
+		std::lock_guard<std::mutex> lock(g_climateMutex);
+		auto it = g_climateTiles.find(key);
+		if (it != g_climateTiles.end())
+		{
+			it->second.lastUse = ++g_climateUses;
+			g_climateStats.hits++;
+			return it->second.tile;
+		}
+	}
+
+	std::shared_ptr<const ClimateTile> tile = buildClimateTile(originX, originZ);
+
+	std::lock_guard<std::mutex> lock(g_climateMutex);
+	g_climateStats.misses++;
+
+	// Chunks in use keep their tile alive through the shared pointer
+	if (g_climateTiles.size() >= g_maxClimateTiles && !g_climateTiles.count(key))
+	{
+		auto oldest = std::min_element(g_climateTiles.begin(), g_climateTiles.end(),
+			[](const std::pair<const uint64_t, CachedTile>& a, const std::pair<const uint64_t, CachedTile>& b) {
+				return a.second.lastUse < b.second.lastUse;
+			});
+		g_climateTiles.erase(oldest);
+	}
+
+	CachedTile& cached = g_climateTiles.emplace(key, CachedTile{ tile, 0 }).first->second;
+	cached.lastUse = ++g_climateUses;
+	return cached.tile;
+}
+
+// The same for a column whichever chunk asks, neighbouring columns get close values
+inline float getColumnDither(int32_t x, int32_t z)
+{
+	uint32_t hash = static_cast<uint32_t>(x) * 0x9E3779B1u ^ static_cast<uint32_t>(z) * 0x85EBCA77u;
+	hash ^= hash >> 15;
+	hash *= 0x2C1B3C6Du;
+	hash ^= hash >> 12;
+	return static_cast<float>(hash & 0xFFFF) / 65536.0f;
+}
+
+ColumnBiome blendBiomes(const glm::vec2& climate, float dither)
+{
+	std::array<float, g_biomeCount> weights;
+	float total = 0.0f;
+	for (uint32_t i = 0; i < g_biomeCount; i++)
+	{
+		const glm::vec2 offset = climate - glm::vec2(g_biomes[i].temperature, g_biomes[i].humidity);
+		weights[i] = std::exp(-glm::dot(offset, offset) / g_biomeSpread);
+		total += weights[i];
+	}
+
+	ColumnBiome column = {};
+	float picked = dither * total;
+	bool typePicked = false;
+	for (uint32_t i = 0; i < g_biomeCount; i++)
+	{
+		const float weight = weights[i] / total;
+		column.heightOffset += weight * g_biomes[i].heightOffset;
+		column.heightScale += weight * g_biomes[i].heightScale;
+		column.stoneLevel += weight * g_biomes[i].stoneLevel;
+		column.snowLevel += weight * g_biomes[i].snowLevel;
+
+		// Surface blocks can't be blended, where two biomes meet they are mixed by weight
+		picked -= weights[i];
+		if (!typePicked && picked < 0.0f)
+		{
+			column.type = g_biomes[i].type;
+			typePicked = true;
+		}
+	}
+	if (!typePicked)
+	{
+		column.type = g_biomes[g_biomeCount - 1].type;
+	}
+	return column;
+}
+
+void GameModule::getChunkBiomes(const glm::ivec3& chunkPos, ChunkBiomes& biomes)
+{
+	const int32_t originX = floorDiv(chunkPos.x, g_regionWidth) * g_regionWidth;
+	const int32_t originZ = floorDiv(chunkPos.z, g_regionWidth) * g_regionWidth;
+	const std::shared_ptr<const ClimateTile> tile = getClimateTile(originX, originZ);
+
+	for (int32_t z = 0; z < g_chunkWidth; z++)
+	{
+		for (int32_t x = 0; x < g_chunkWidth; x++)
+		{
+			const int32_t localX = chunkPos.x - originX + x;
+			const int32_t localZ = chunkPos.z - originZ + z;
+			const int32_t sx = localX / g_climateStep;
+			const int32_t sz = localZ / g_climateStep;
+			const float tx = static_cast<float>(localX % g_climateStep) / g_climateStep;
+			const float tz = static_cast<float>(localZ % g_climateStep) / g_climateStep;
+
+			const glm::vec2* samples = &tile->climate[g_climateSamples * sz + sx];
+			const glm::vec2 climate = glm::mix(
+				glm::mix(samples[0], samples[1], tx),
+				glm::mix(samples[g_climateSamples], samples[g_climateSamples + 1], tx),
+				tz);
+
+			biomes[g_chunkWidth * z + x] = blendBiomes(climate, getColumnDither(chunkPos.x + x, chunkPos.z + z));
+		}
+	}
+}
+
+BlockType GameModule::getSurfaceBlock(BiomeType type)
+{
+	return g_biomes[static_cast<uint32_t>(type)].surface;
+}
+
+BlockType GameModule::getFillerBlock(BiomeType type)
+{
+	return g_biomes[static_cast<uint32_t>(type)].filler;
+}
+
+float GameModule::getTreeDensity(BiomeType type)
+{
+	return g_biomes[static_cast<uint32_t>(type)].trees;
+}
+
+ClimateCacheStats GameModule::getClimateCacheStats()
+{
+	std::lock_guard<std::mutex> lock(g_climateMutex);
+	ClimateCacheStats stats = g_climateStats;
+	stats.tiles = static_cast<uint32_t>(g_climateTiles.size());
+	return stats;
+}
+
+void GameModule::clearClimateCache()
+{
+	std::lock_guard<std::mutex> lock(g_climateMutex);
+	g_climateTiles.clear();
+	g_climateStats = {};
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+#include "block.h"
+
+namespace GameModule
+{
+	enum class BiomeType : uint8_t
+	{
+		PLAINS,
+		FOREST,
+		DESERT,
+		MOUNTAINS,
+		TUNDRA
+	};
+
+	// What the generation of a column takes from the biomes around it, blended by climate
+	struct ColumnBiome
+	{
+		BiomeType	type;			// Picks the surface blocks, dithered between close biomes
+		float		heightOffset;
+		float		heightScale;
+		float		stoneLevel;		// Columns higher than this are bare stone
+		float		snowLevel;		// Everything above it is snow
+	};
+
+	using ChunkBiomes = std::array<ColumnBiome, 16 * 16>;
+
+	struct ClimateCacheStats
+	{
+		uint32_t	tiles;
+		uint64_t	hits;
+		uint64_t	misses;
+	};
+
+	// Safe to call from several generation threads, the climate of a region is sampled once
+	void getChunkBiomes(const glm::ivec3& chunkPos, ChunkBiomes& biomes);
+
+	BlockType getSurfaceBlock(BiomeType type);
+	BlockType getFillerBlock(BiomeType type);
+	float getTreeDensity(BiomeType type); // Chance of a tree per 4x4 column cell
+
+	ClimateCacheStats getClimateCacheStats();
+	void clearClimateCache();
+}
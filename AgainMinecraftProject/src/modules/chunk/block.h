@@ -20,14 +20,63 @@ namespace GameModule
 		STONE,
 		SAND,
 		SNOW,
-		WATER
+		WATER,
+		LAMP,
+		LOG,
+		LEAVES
+	};
+
+	enum class TerrainMode
+	{
+		HEIGHTMAP,	// Solid up to the 2D noise height
+		DENSITY		// 3D noise on top of it, with overhangs and caves
 	};
 
 	struct Block
 	{
-		BlockType type;
+		BlockType	type;
+		uint8_t		data; // Water keeps its level in the low bits, the light is in the high ones
 	};
 
+	constexpr uint8_t g_lightShift = 4;
+	constexpr uint8_t g_lightMask = 0xF0;
+	constexpr uint8_t g_maxLight = 15;
+
+	// A block a pass computed for the given id of a chunk, written once the pass is done
+	struct BlockWrite
+	{
+		uint32_t	id;
+		Block		block;
+	};
+
+	// Nothing can pass through them, unlike air and water
+	inline bool isSolidBlock(BlockType type)
+	{
+		return type != BlockType::AIR && type != BlockType::WATER;
+	}
+
+	inline uint8_t getBlockLight(const Block& block)
+	{
+		return block.data >> g_lightShift;
+	}
+
+	inline void setBlockLight(Block& block, uint8_t light)
+	{
+		block.data = (block.data & ~g_lightMask) | light << g_lightShift;
+	}
+
+	// Light a block gives off by itself
+	inline uint8_t getLightEmission(BlockType type)
+	{
+		return type == BlockType::LAMP ? g_maxLight : 0;
+	}
+
+	// Fall down as soon as nothing solid is under them
+	inline bool isFallingBlock(BlockType type)
+	{
+		return type == BlockType::SAND;
+	}
+
 	struct Face
 	{
 		enum class FaceType
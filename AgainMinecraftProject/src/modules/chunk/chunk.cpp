@@ -11,13 +11,18 @@
 #include <glm/glm.hpp>
 #include <iostream>
 #include <array>
+#include <limits>
 #include <FastNoiseLite.h>
 
 #include "../../engine/renderer/mesh.h"
+#include "../../engine/renderer/commands.h"
 #include "../../engine/ray/ray.h"
 #include "../../engine/texture/texture_list.h"
+#include "../../engine/profiler/trace.h"
+#include "../../engine/noise/noise.h"
 
 #include "block.h"
+#include "biome.h"
 #include "chunk.h"
 
 using namespace Engine::Renderer;
@@ -28,7 +33,24 @@ constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
 
 constexpr uint32_t g_nBlocks = g_chunkSize.x * g_chunkSize.y * g_chunkSize.z;
 
-constexpr uint32_t g_heightOffset = 80;
+constexpr float g_waterLevel = 100.0f;
+
+// Density terrain samples its 3D noise every 4x8x4 blocks and interpolates in between
+constexpr int32_t g_densityStepXZ = 4;
+constexpr int32_t g_densityStepY = 8;
+constexpr int32_t g_densityX = g_chunkSize.x / g_densityStepXZ + 1;
+constexpr int32_t g_densityY = g_chunkSize.y / g_densityStepY + 1;
+constexpr int32_t g_densityZ = g_chunkSize.z / g_densityStepXZ + 1;
+constexpr uint32_t g_densityPoints = g_densityX * g_densityY * g_densityZ;
+
+constexpr float g_overhangFrequency = 1.0f / 40.0f;
+constexpr float g_overhangAmplitude = 16.0f; // Blocks the surface moves up or down
+constexpr float g_overhangRise = 24.0f; // Height above the water it takes to reach the full amplitude
+constexpr float g_caveFrequency = 1.0f / 28.0f;
+constexpr float g_caveThreshold = 0.3f;
+constexpr float g_caveOffset = 512.5f; // Keeps the caves apart from the overhangs
+constexpr float g_caveShore = 4.0f; // Caves stay this far above the water level, they'd flood
+constexpr int32_t g_caveFloor = 4;
 
 constexpr float g_rayDeltaMag = 0.1f;
 
@@ -112,21 +134,19 @@ FaceMap g_faces = {
 };
 
 
-BlockType getBlockType(Chunk& chunk, const glm::vec3& pos, const float height)
+BlockType getBlockType(Chunk& chunk, const glm::vec3& pos, const float height, const ColumnBiome& biome)
 {
-	float waterLevel = 100.0f;
+	float waterLevel = g_waterLevel;
 
 	if (pos.y <= height)
 	{
 		float dirtHeight = height - 3;
-		float mountainLevel = 155.0f;
-		float peakLevel = 160.0f;
 
-		if (pos.y > peakLevel)
+		if (pos.y > biome.snowLevel)
 		{
 			return BlockType::SNOW;
 		}
-		if (height > mountainLevel)
+		if (height > biome.stoneLevel)
 		{
 			return BlockType::STONE;
 		}
@@ -135,13 +155,13 @@ BlockType getBlockType(Chunk& chunk, const glm::vec3& pos, const float height)
 		{
 			if (pos.y > waterLevel + 1)
 			{
-				return BlockType::GRASS;
+				return getSurfaceBlock(biome.type);
 			}
 			return BlockType::SAND;
 		}
 		if (pos.y > dirtHeight)
 		{
-			return BlockType::DIRT;
+			return getFillerBlock(biome.type);
 		}
 
 		return BlockType::STONE;
@@ -155,8 +175,115 @@ BlockType getBlockType(Chunk& chunk, const glm::vec3& pos, const float height)
 	return BlockType::AIR;
 }
 
-Chunk GameModule::generateChunk(const glm::ivec3& pos)
+// Generated bottom to top, the last block of a kind in a column is its highest
+inline void raiseColumnHeights(HeightMap& heights, uint32_t column, int32_t y, BlockType type)
 {
+	if (isSolidBlock(type))
+	{
+		heights.opaque[column] = y + 1;
+	}
+	if (type != BlockType::AIR)
+	{
+		heights.surface[column] = y + 1;
+	}
+}
+
+// Two octaves of the batched noise at every grid point of the chunk
+void sampleGridNoise(const glm::vec3& origin, float frequency, std::array<float, g_densityPoints>& out)
+{
+	std::array<float, g_densityPoints> x, y, z, octave;
+	for (int32_t gy = 0, i = 0; gy < g_densityY; gy++)
+	{
+		for (int32_t gz = 0; gz < g_densityZ; gz++)
+		{
+			for (int32_t gx = 0; gx < g_densityX; gx++, i++)
+			{
+				x[i] = (origin.x + gx * g_densityStepXZ) * frequency;
+				y[i] = (origin.y + gy * g_densityStepY) * frequency;
+				z[i] = (origin.z + gz * g_densityStepXZ) * frequency;
+			}
+		}
+	}
+	Engine::Noise::perlin3D(x.data(), y.data(), z.data(), out.data(), g_densityPoints);
+
+	for (uint32_t i = 0; i < g_densityPoints; i++)
+	{
+		x[i] *= 2.0f;
+		y[i] *= 2.0f;
+		z[i] *= 2.0f;
+	}
+	Engine::Noise::perlin3D(x.data(), y.data(), z.data(), octave.data(), g_densityPoints);
+
+	for (uint32_t i = 0; i < g_densityPoints; i++)
+	{
+		out[i] = (out[i] + 0.5f * octave[i]) / 1.5f;
+	}
+}
+
+// Bilinear in x and z, the blocks of the column then only interpolate along y
+void interpolateColumn(const std::array<float, g_densityPoints>& grid, int32_t x, int32_t z, std::array<float, g_densityY>& column)
+{
+	const int32_t gx = x / g_densityStepXZ;
+	const int32_t gz = z / g_densityStepXZ;
+	const float tx = static_cast<float>(x % g_densityStepXZ) / g_densityStepXZ;
+	const float tz = static_cast<float>(z % g_densityStepXZ) / g_densityStepXZ;
+
+	for (int32_t gy = 0; gy < g_densityY; gy++)
+	{
+		const uint32_t i = (gy * g_densityZ + gz) * g_densityX + gx;
+		const float back = glm::mix(grid[i], grid[i + 1], tx);
+		const float front = glm::mix(grid[i + g_densityX], grid[i + g_densityX + 1], tx);
+		column[gy] = glm::mix(back, front, tz);
+	}
+}
+
+// The 2D height moved up and down by 3D noise gives overhangs, a second noise carves the caves
+void generateDensityBlocks(Chunk& chunk, const std::array<uint32_t, g_chunkColumns>& heightMap, const ChunkBiomes& biomes)
+{
+	std::array<float, g_densityPoints> overhangs, caves;
+	sampleGridNoise(chunk.pos, g_overhangFrequency, overhangs);
+	sampleGridNoise(chunk.pos + glm::vec3(g_caveOffset), g_caveFrequency, caves);
+
+	chunk.blocks.resize(g_nBlocks);
+
+	std::array<float, g_densityY> overhangColumn, caveColumn;
+	for (int32_t z = 0; z < g_chunkSize.z; z++)
+	{
+		for (int32_t x = 0; x < g_chunkSize.x; x++)
+		{
+			const uint32_t column = g_chunkSize.x * z + x;
+			interpolateColumn(overhangs, x, z, overhangColumn);
+			interpolateColumn(caves, x, z, caveColumn);
+
+			// Flat at the shore, so the water never ends up next to a dry hole
+			const float height = static_cast<float>(heightMap[column]);
+			const float amplitude = g_overhangAmplitude * glm::clamp((height - g_waterLevel) / g_overhangRise, 0.0f, 1.0f);
+			const bool carved = height > g_waterLevel + g_caveShore;
+
+			for (int32_t y = 0; y < g_chunkSize.y; y++)
+			{
+				const int32_t gy = y / g_densityStepY;
+				const float ty = static_cast<float>(y % g_densityStepY) / g_densityStepY;
+				const float overhang = glm::mix(overhangColumn[gy], overhangColumn[gy + 1], ty);
+
+				BlockType type = getBlockType(chunk, chunk.pos + glm::vec3(x, y, z), std::floor(height + overhang * amplitude), biomes[column]);
+				if (carved && y > g_caveFloor && isSolidBlock(type) &&
+					glm::mix(caveColumn[gy], caveColumn[gy + 1], ty) > g_caveThreshold)
+				{
+					type = BlockType::AIR;
+				}
+
+				chunk.blocks[g_chunkColumns * y + column].type = type;
+				raiseColumnHeights(chunk.heights, column, y, type);
+			}
+		}
+	}
+}
+
+Chunk GameModule::generateChunk(const glm::ivec3& pos, TerrainMode mode)
+{
+	TRACE_SCOPE("generateChunk");
+
 	Chunk chunk;
 	chunk.pos = pos;
 	chunk.front = pos + glm::ivec3(0, 0, g_chunkSize.z);
@@ -170,6 +297,9 @@ Chunk GameModule::generateChunk(const glm::ivec3& pos)
 	}
 
 	std::array<uint32_t, g_chunkSize.x* g_chunkSize.z> heightMap;
+	ChunkBiomes biomes;
+	getChunkBiomes(pos, biomes);
+
 	FastNoiseLite generator1;
 	generator1.SetNoiseType(FastNoiseLite::NoiseType_OpenSimplex2);
 	generator1.SetFractalType(FastNoiseLite::FractalType_FBm);
@@ -214,21 +344,30 @@ Chunk GameModule::generateChunk(const glm::ivec3& pos)
 			blendedNoise = glm::pow(blendedNoise, 2.477f);
 
 
+			// The biomes decide how flat the same noise comes out
+			const ColumnBiome& biome = biomes[g_chunkSize.x * z + x];
 			heightMap[g_chunkSize.x * z + x] =
-				(g_heightOffset + 200.0f * blendedNoise);
+				static_cast<uint32_t>(biome.heightOffset + biome.heightScale * blendedNoise);
 		}
 	}
 
+	if (mode == TerrainMode::DENSITY)
+	{
+		generateDensityBlocks(chunk, heightMap, biomes);
+		return chunk;
+	}
+
 	for (int32_t y = 0; y < g_chunkSize.y; y++)
 	{
 		for (int32_t z = 0; z < g_chunkSize.z; z++)
 		{
 			for (int32_t x = 0; x < g_chunkSize.x; x++)
 			{
-				Block block;
+				Block block = {};
 				uint32_t heightId = g_chunkSize.x * z + x;
-				block.type = getBlockType(chunk, chunk.pos + glm::vec3(x, y, z), heightMap[heightId]);
+				block.type = getBlockType(chunk, chunk.pos + glm::vec3(x, y, z), heightMap[heightId], biomes[heightId]);
 				chunk.blocks.push_back(block);
+				raiseColumnHeights(chunk.heights, heightId, y, block.type);
 			}
 		}
 	}
@@ -280,9 +419,25 @@ Engine::TextureId getFaceId(BlockType type, Face::FaceType face)
 	{
 		return Engine::TextureId::WATER;
 	}
+
+	if (type == BlockType::LAMP)
+	{
+		return Engine::TextureId::LAMP;
+	}
+
+	if (type == BlockType::LOG)
+	{
+		return Engine::TextureId::LOG;
+	}
+
+	if (type == BlockType::LEAVES)
+	{
+		return Engine::TextureId::LEAVES;
+	}
 }
 
-void updateFace(Chunk& chunk, const glm::ivec3 pos, BlockType type, Face::FaceType face)
+// The light is the one of the cell the face looks into
+void updateFace(Chunk& chunk, const glm::ivec3 pos, BlockType type, Face::FaceType face, uint8_t light)
 {
 	uint8_t texID = static_cast<const uint8_t>(getFaceId(type, face));
 
@@ -300,6 +455,8 @@ void updateFace(Chunk& chunk, const glm::ivec3 pos, BlockType type, Face::FaceTy
 		data |= (texCoord & 0x3) << 19;	// Coord ind
 		data |= (texID & 0xF) << 21;	// tex id
 		data |= (normalID & 0x3) << 25; // normal id
+		data |= (light & g_skyLit ? 1 : 0) << 27; // sky lit
+		data |= static_cast<int32_t>((light & 0xFu) << 28); // block light
 
 		if (type == BlockType::WATER)
 		{
@@ -308,14 +465,64 @@ void updateFace(Chunk& chunk, const glm::ivec3 pos, BlockType type, Face::FaceTy
 		else
 		{
 			chunk.solidMesh.push_back({ data });
+			chunk.minSolidY = std::min(chunk.minSolidY, posData.y);
+			chunk.maxSolidY = std::max(chunk.maxSolidY, posData.y);
 		}
 	}
 }
 
-void GameModule::setBlockFace(Chunk& chunk, const glm::vec3& pos, BlockType type, Face::FaceType face)
+void GameModule::setBlockFace(Chunk& chunk, const glm::vec3& pos, BlockType type, Face::FaceType face, uint8_t light)
 {
 	chunk.updated = false;
-	updateFace(chunk, pos, type, face);
+	updateFace(chunk, pos, type, face, light);
+}
+
+uint8_t GameModule::getCellLight(const Chunk& chunk, uint32_t id)
+{
+	const bool skyLit = id / g_chunkColumns >= chunk.heights.opaque[id % g_chunkColumns];
+	return getBlockLight(chunk.blocks[id]) | (skyLit ? g_skyLit : 0);
+}
+
+// One above the highest block under the given height that counts, 0 without one
+template <typename F>
+uint16_t findColumnTop(const Chunk& chunk, uint32_t column, uint32_t height, F&& counts)
+{
+	for (; height > 0; height--)
+	{
+		if (counts(chunk.blocks[g_chunkColumns * (height - 1) + column].type))
+		{
+			break;
+		}
+	}
+	return static_cast<uint16_t>(height);
+}
+
+void GameModule::updateColumnHeights(Chunk& chunk, const glm::ivec3& local)
+{
+	const uint32_t column = g_chunkSize.x * local.z + local.x;
+	const uint16_t above = static_cast<uint16_t>(local.y + 1);
+	const BlockType type = chunk.blocks[g_chunkColumns * local.y + column].type;
+
+	// A block on top raises the column, taking the top one away drops it to the next one down
+	uint16_t& opaque = chunk.heights.opaque[column];
+	if (isSolidBlock(type))
+	{
+		opaque = std::max(opaque, above);
+	}
+	else if (opaque == above)
+	{
+		opaque = findColumnTop(chunk, column, local.y, isSolidBlock);
+	}
+
+	uint16_t& surface = chunk.heights.surface[column];
+	if (type != BlockType::AIR)
+	{
+		surface = std::max(surface, above);
+	}
+	else if (surface == above)
+	{
+		surface = findColumnTop(chunk, column, local.y, [](BlockType type) { return type != BlockType::AIR; });
+	}
 }
 
 void GameModule::removeBlockFace(Chunk& chunk, uint32_t id, Face::FaceType type)
@@ -329,8 +536,11 @@ void GameModule::updateMesh(Chunk& chunk, Engine::Renderer::MeshBuffer& transBuf
 	updateMesh(solidBuffer, chunk.transparentMesh);
 }
 
-void GameModule::updateChunkNeighbourFace(Chunk& chunk1, Chunk& chunk2)
+// Faces go to whichever side is open, only limits them to one of the chunks
+void stitchFaces(Chunk& chunk1, Chunk& chunk2, const Chunk* only)
 {
+	TRACE_SCOPE("stitchChunk");
+
 	auto& less =
 		chunk1.pos.x < chunk2.pos.x || chunk1.pos.z < chunk2.pos.z ? chunk1 : chunk2;
 	auto& more =
@@ -353,21 +563,29 @@ void GameModule::updateChunkNeighbourFace(Chunk& chunk1, Chunk& chunk2)
 					less.blocks[iLess].type == BlockType::AIR && moreSolid ||
 					less.blocks[iLess].type == BlockType::AIR && more.blocks[iMore].type == BlockType::WATER)
 				{
-					setBlockFace(
-						more,
-						glm::vec3(0, y, z),
-						more.blocks[iMore].type,
-						Face::FaceType::LEFT);
+					if (!only || only == &more)
+					{
+						setBlockFace(
+							more,
+							glm::vec3(0, y, z),
+							more.blocks[iMore].type,
+							Face::FaceType::LEFT,
+							getCellLight(less, iLess));
+					}
 				}
 				else if (more.blocks[iMore].type == BlockType::WATER && lessSolid ||
 					more.blocks[iMore].type == BlockType::AIR && lessSolid ||
 					more.blocks[iMore].type == BlockType::AIR && less.blocks[iLess].type == BlockType::WATER)
 				{
-					setBlockFace(
-						less,
-						glm::vec3(g_chunkSize.x - 1, y, z),
-						less.blocks[iLess].type,
-						Face::FaceType::RIGHT);
+					if (!only || only == &less)
+					{
+						setBlockFace(
+							less,
+							glm::vec3(g_chunkSize.x - 1, y, z),
+							less.blocks[iLess].type,
+							Face::FaceType::RIGHT,
+							getCellLight(more, iMore));
+					}
 				}
 			}
 		}
@@ -390,75 +608,324 @@ void GameModule::updateChunkNeighbourFace(Chunk& chunk1, Chunk& chunk2)
 					less.blocks[iLess].type == BlockType::AIR && moreSolid ||
 					less.blocks[iLess].type == BlockType::AIR && more.blocks[iMore].type == BlockType::WATER)
 				{
-					setBlockFace(
-						more,
-						glm::vec3(x, y, 0),
-						more.blocks[iMore].type,
-						Face::FaceType::BACK);
+					if (!only || only == &more)
+					{
+						setBlockFace(
+							more,
+							glm::vec3(x, y, 0),
+							more.blocks[iMore].type,
+							Face::FaceType::BACK,
+							getCellLight(less, iLess));
+					}
 				}
 				else if (more.blocks[iMore].type == BlockType::WATER && lessSolid ||
 					more.blocks[iMore].type == BlockType::AIR && lessSolid ||
 					more.blocks[iMore].type == BlockType::AIR && less.blocks[iLess].type == BlockType::WATER)
 				{
-					setBlockFace(
-						less,
-						glm::vec3(x, y, g_chunkSize.z - 1),
-						less.blocks[iLess].type,
-						Face::FaceType::FRONT);
+					if (!only || only == &less)
+					{
+						setBlockFace(
+							less,
+							glm::vec3(x, y, g_chunkSize.z - 1),
+							less.blocks[iLess].type,
+							Face::FaceType::FRONT,
+							getCellLight(more, iMore));
+					}
 				}
 			}
 		}
 	}
 }
 
-void GameModule::loadChunkMesh(Chunk& chunk)
+void GameModule::updateChunkNeighbourFace(Chunk& chunk1, Chunk& chunk2)
+{
+	stitchFaces(chunk1, chunk2, nullptr);
+}
+
+void GameModule::stitchChunkFaces(Chunk& chunk, Chunk& neighbour)
+{
+	stitchFaces(chunk, neighbour, &chunk);
+}
+
+inline bool isCaster(BlockType type)
+{
+	return type != BlockType::AIR && type != BlockType::WATER;
+}
+
+inline int32_t packCasterVertex(const glm::ivec3& pos)
+{
+	return (pos.x & 0x1F) | (pos.y & 0x1FF) << 5 | (pos.z & 0x1F) << 14;
+}
+
+uint8_t GameModule::getLightOctant(const glm::vec3& lightDir)
+{
+	// Two bits per axis: 0 - parallel to the axis, 1 - positive, 2 - negative
+	uint8_t octant = 0;
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		if (lightDir[axis] > 0.0f)
+		{
+			octant |= 1 << (axis * 2);
+		}
+		else if (lightDir[axis] < 0.0f)
+		{
+			octant |= 2 << (axis * 2);
+		}
+	}
+	return octant;
+}
+
+void addCasterFaces(Chunk& chunk, const Chunk* neighbour, uint32_t axis, int32_t dir)
+{
+	const uint32_t uAxis = axis == 0 ? 2 : 0;
+	const uint32_t vAxis = axis == 1 ? 2 : 1;
+	const int32_t uSize = g_chunkSize[uAxis];
+	const int32_t vSize = g_chunkSize[vAxis];
+
+	std::array<bool, g_chunkSize.x * g_chunkSize.y> mask;
+
+	for (int32_t d = 0; d < g_chunkSize[axis]; d++)
+	{
+		// Mask of the solid blocks whose face along dir is open
+		for (int32_t v = 0; v < vSize; v++)
+		{
+			for (int32_t u = 0; u < uSize; u++)
+			{
+				glm::ivec3 pos;
+				pos[axis] = d;
+				pos[uAxis] = u;
+				pos[vAxis] = v;
+
+				glm::ivec3 next = pos;
+				next[axis] += dir;
+
+				bool open = false;
+				if (next[axis] >= 0 && next[axis] < g_chunkSize[axis])
+				{
+					open = !isCaster(chunk.blocks[g_chunkSize.x * (next.y * g_chunkSize.z + next.z) + next.x].type);
+				}
+				else if (axis == 1)
+				{
+					open = next.y >= g_chunkSize.y;
+				}
+				else if (neighbour)
+				{
+					next[axis] = (next[axis] + g_chunkSize[axis]) % g_chunkSize[axis];
+					open = !isCaster(neighbour->blocks[g_chunkSize.x * (next.y * g_chunkSize.z + next.z) + next.x].type);
+				}
+
+				mask[uSize * v + u] =
+					open && isCaster(chunk.blocks[g_chunkSize.x * (pos.y * g_chunkSize.z + pos.z) + pos.x].type);
+			}
+		}
+
+		// Greedy merge of the mask into quads
+		for (int32_t v = 0; v < vSize; v++)
+		{
+			for (int32_t u = 0; u < uSize;)
+			{
+				if (!mask[uSize * v + u])
+				{
+					u++;
+					continue;
+				}
+
+				int32_t width = 1;
+				while (u + width < uSize && mask[uSize * v + u + width])
+				{
+					width++;
+				}
+
+				int32_t height = 1;
+				for (; v + height < vSize; height++)
+				{
+					bool fullRow = true;
+					for (int32_t k = 0; k < width && fullRow; k++)
+					{
+						fullRow = mask[uSize * (v + height) + u + k];
+					}
+
+					if (!fullRow)
+					{
+						break;
+					}
+				}
+
+				for (int32_t h = 0; h < height; h++)
+				{
+					std::fill_n(mask.begin() + uSize * (v + h) + u, width, false);
+				}
+
+				glm::ivec3 corners[4];
+				for (uint32_t iCorner = 0; iCorner < 4; iCorner++)
+				{
+					corners[iCorner][axis] = dir > 0 ? d + 1 : d;
+					corners[iCorner][uAxis] = u + (iCorner & 1 ? width : 0);
+					corners[iCorner][vAxis] = v + (iCorner & 2 ? height : 0);
+				}
+
+				for (uint32_t iCorner : { 0, 1, 2, 1, 3, 2 })
+				{
+					chunk.casterMesh.push_back({ packCasterVertex(corners[iCorner]) });
+				}
+
+				u += width;
+			}
+		}
+	}
+}
+
+void GameModule::buildCasterMesh(Chunk& chunk, const Chunk* neighbourX, const Chunk* neighbourZ, uint8_t octant)
+{
+	TRACE_SCOPE("buildCasterMesh");
+
+	chunk.casterMesh.clear();
+	chunk.casterOctant = octant;
+	chunk.casterUpdated = false;
+
+	// Only faces looking towards the light can be the closest surface in the shadow map
+	const Chunk* neighbours[] = { neighbourX, nullptr, neighbourZ };
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		const uint8_t sign = (octant >> (axis * 2)) & 0x3;
+		if (sign)
+		{
+			addCasterFaces(chunk, neighbours[axis], axis, sign == 1 ? 1 : -1);
+		}
+	}
+}
+
+// Scratch storage for sorting water faces, reused between calls
+static std::vector<std::pair<float, uint32_t>> g_faceOrder;
+static Mesh g_sortedFaces;
+
+void GameModule::sortTransparentFaces(Chunk& chunk, const glm::vec3& viewPos)
+{
+	const uint32_t nFaces = chunk.transparentMesh.size() / g_vertexPerFace;
+	const glm::vec3 localViewPos = viewPos - chunk.pos;
+
+	g_faceOrder.clear();
+	for (uint32_t iFace = 0; iFace < nFaces; iFace++)
+	{
+		glm::ivec3 min = glm::ivec3(std::numeric_limits<int32_t>::max());
+		glm::ivec3 max = glm::ivec3(std::numeric_limits<int32_t>::min());
+		for (uint32_t iVertex = 0; iVertex < g_vertexPerFace; iVertex++)
+		{
+			const int32_t data = chunk.transparentMesh[iFace * g_vertexPerFace + iVertex].data;
+			const glm::ivec3 pos = { data & 0x1F, (data >> 5) & 0x1FF, (data >> 14) & 0x1F };
+			min = glm::min(min, pos);
+			max = glm::max(max, pos);
+		}
+
+		const glm::vec3 toFace = glm::vec3(min + max) * 0.5f - localViewPos;
+		g_faceOrder.push_back({ glm::dot(toFace, toFace), iFace });
+	}
+
+	std::sort(g_faceOrder.begin(), g_faceOrder.end(),
+		[](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+			return a.first > b.first;
+		});
+
+	g_sortedFaces.clear();
+	for (const auto& face : g_faceOrder)
+	{
+		const auto first = chunk.transparentMesh.begin() + face.second * g_vertexPerFace;
+		g_sortedFaces.insert(g_sortedFaces.end(), first, first + g_vertexPerFace);
+	}
+	// Copied back instead of swapped, so the scratch keeps the biggest capacity
+	std::copy(g_sortedFaces.begin(), g_sortedFaces.end(), chunk.transparentMesh.begin());
+}
+
+void GameModule::releaseChunkMeshes(Chunk& chunk, bool keepTransparent)
+{
+	// Swapped out, clear() would keep the capacity
+	Mesh().swap(chunk.solidMesh);
+	if (!keepTransparent)
+	{
+		Mesh().swap(chunk.transparentMesh);
+	}
+	chunk.meshReleased = true;
+}
+
+void GameModule::loadChunkMesh(Chunk& chunk, CommandList& commands)
 {
 	if (chunk.transBuffer)
 	{
-		updateMesh(*chunk.transBuffer, chunk.transparentMesh);
+		cmdUpload(commands, *chunk.transBuffer, chunk.transparentMesh);
+		chunk.transVertices = chunk.transparentMesh.size();
 	}
 
 	if (chunk.solidBuffer)
 	{
-		updateMesh(*chunk.solidBuffer, chunk.solidMesh);
+		cmdUpload(commands, *chunk.solidBuffer, chunk.solidMesh);
 	}
 }
 
-void GameModule::drawSolid(const Chunk& chunk)
+void GameModule::loadCasterMesh(Chunk& chunk, CommandList& commands)
+{
+	if (chunk.casterBuffer)
+	{
+		cmdUpload(commands, *chunk.casterBuffer, chunk.casterMesh);
+		chunk.casterUpdated = true;
+	}
+}
+
+void GameModule::drawSolid(const Chunk& chunk, CommandList& commands)
 {
 	if (chunk.solidBuffer)
 	{
-		renderMesh(*chunk.solidBuffer);
+		cmdDraw(commands, *chunk.solidBuffer);
 	}
 }
 
-void GameModule::drawTrans(const Chunk& chunk)
+void GameModule::drawTrans(const Chunk& chunk, CommandList& commands)
 {
-	if (chunk.transparentMesh.size() > 0)
+	if (chunk.transBuffer && chunk.transVertices > 0)
 	{
-		renderMesh(*chunk.transBuffer);
+		cmdDraw(commands, *chunk.transBuffer);
 	}
 }
 
-uint32_t GameModule::disableChunk(Chunk& chunk)
+void GameModule::drawCaster(const Chunk& chunk, CommandList& commands)
 {
-	uint32_t disabledBuffers = 0;
+	if (chunk.casterBuffer)
+	{
+		cmdDraw(commands, *chunk.casterBuffer);
+	}
+}
 
+void GameModule::disableChunk(Chunk& chunk, BufferPool& pool)
+{
+	// Buffers keep their storage, the next chunk reuses it
 	if (chunk.solidBuffer)
 	{
-		updateMesh(*chunk.solidBuffer, {});
-		chunk.solidBuffer->active = false;
+		releaseBuffer(pool, *chunk.solidBuffer);
 		chunk.solidBuffer = nullptr;
-		disabledBuffers++;
 	}
 
 	if (chunk.transBuffer)
 	{
-		updateMesh(*chunk.transBuffer, {});
-		chunk.transBuffer->active = false;
+		releaseBuffer(pool, *chunk.transBuffer);
 		chunk.transBuffer = nullptr;
-		disabledBuffers++;
 	}	
 
-	return disabledBuffers;
+	if (chunk.casterBuffer)
+	{
+		releaseBuffer(pool, *chunk.casterBuffer);
+		chunk.casterBuffer = nullptr;
+	}
+}
+
+bool GameModule::acquireChunkBuffers(Chunk& chunk, BufferPool& pool)
+{
+	if (pool.nFree < 3)
+	{
+		return false;
+	}
+
+	chunk.solidBuffer = acquireBuffer(pool, chunk.solidMesh.size() * sizeof(Vertex));
+	chunk.transBuffer = acquireBuffer(pool, chunk.transparentMesh.size() * sizeof(Vertex));
+	chunk.casterBuffer = acquireBuffer(pool, chunk.casterMesh.size() * sizeof(Vertex));
+
+	return true;
 }
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 #include <stdint.h>
+#include <array>
+#include <limits>
 #include <queue>
 #include <vector>
 
@@ -9,16 +11,36 @@
 
 #include "block.h"
 
+constexpr uint8_t g_invalidOctant = 0xFF;
+constexpr uint32_t g_chunkColumns = 16 * 16;
+constexpr uint32_t g_chunkSections = 256 / 16;
+constexpr uint8_t g_skyLit = 0x10; // Next to the block light of a cell the sun reaches
+
 namespace Engine
 {
 	struct Ray;
 	struct Shader;
+
+	namespace Renderer
+	{
+		struct CommandList;
+	}
 }
 
 namespace GameModule
 {
 	struct Block;
 
+	// Per column, the height right above the highest block of a kind, 0 without one
+	struct HeightMap
+	{
+		std::array<uint16_t, g_chunkColumns>	opaque;		// The sun doesn't get past it
+		std::array<uint16_t, g_chunkColumns>	surface;	// Anything but air
+	};
+
+	// Per section and side, the sides an opening from it leads to, in the order of SectionFace
+	using SectionLinks = std::array<std::array<uint8_t, 6>, g_chunkSections>;
+
 	struct Chunk
 	{
 		glm::ivec3	front;
@@ -29,11 +51,33 @@ namespace GameModule
 		bool					updated = false;
 		glm::vec3				pos;
 		std::vector<Block>		blocks = {};
+		HeightMap				heights = {}; // Follows every edit through setBlock
+		bool					populated = false; // Its features are in, some of them in the neighbours
+
+		SectionLinks			links = {}; // Rebuilt with the faces
+		uint16_t				skyFloor = 0; // Lowest opaque height of its columns, with the links
+		uint16_t				visibleSections = 0xFFFF; // Reached by the visibility search of this frame
+		bool					shadowVisible = true; // Its shadow may fall on a reached section
 		Engine::Renderer::Mesh	solidMesh;
 		Engine::Renderer::Mesh	transparentMesh;
 
+		// CPU meshes can be dropped after the upload, editing them needs a remesh
+		bool					meshReleased = false;
+		uint32_t				transVertices = 0; // Of the uploaded transparent mesh
+
+		// Vertical extent of the solid mesh, used to cull shadow casters
+		int32_t					minSolidY = std::numeric_limits<int32_t>::max();
+		int32_t					maxSolidY = std::numeric_limits<int32_t>::min();
+
+		// Depth only mesh for the shadow pass, has to be rebuilt
+		// when blocks change or the light changes its octant
+		Engine::Renderer::Mesh	casterMesh;
+		uint8_t					casterOctant = g_invalidOctant;
+		bool					casterUpdated = false;
+
 		Engine::Renderer::MeshBuffer* solidBuffer = nullptr;
 		Engine::Renderer::MeshBuffer* transBuffer = nullptr;
+		Engine::Renderer::MeshBuffer* casterBuffer = nullptr;
 	};
 
 	enum class RayType
@@ -43,15 +87,29 @@ namespace GameModule
 		PLACE
 	};
 
-	Chunk	generateChunk(const glm::ivec3& pos);
+	Chunk	generateChunk(const glm::ivec3& pos, TerrainMode mode);
 	void	updateMesh(Chunk& chunk, Engine::Renderer::MeshBuffer& transBuffer, Engine::Renderer::MeshBuffer& solidBuffer);
 	void	updateChunkNeighbourFace(Chunk& chunk1, Chunk& chunk2);
+	void	stitchChunkFaces(Chunk& chunk, Chunk& neighbour); // Only adds the faces of chunk
+
+	void	setBlockFace(Chunk& chunk, const glm::vec3& pos, BlockType type, Face::FaceType face, uint8_t light);
 
-	void	setBlockFace(Chunk& chunk, const glm::vec3& pos, BlockType type, Face::FaceType face);
+	uint8_t	getCellLight(const Chunk& chunk, uint32_t id); // What the faces looking into the cell bake in
+	void	updateColumnHeights(Chunk& chunk, const glm::ivec3& local); // After the block there changed
 	void	removeBlockFace(Chunk& chunk, uint32_t id, Face::FaceType type);
 
-	void	 loadChunkMesh(Chunk& chunk);
-	void	 drawSolid(const Chunk& chunk);
-	void	 drawTrans(const Chunk& chunk);
-	uint32_t disableChunk(Chunk& chunk);
+	uint8_t	 getLightOctant(const glm::vec3& lightDir);
+	void	 buildCasterMesh(Chunk& chunk, const Chunk* neighbourX, const Chunk* neighbourZ, uint8_t octant);
+
+	void	 sortTransparentFaces(Chunk& chunk, const glm::vec3& viewPos);
+
+	void	 releaseChunkMeshes(Chunk& chunk, bool keepTransparent);
+
+	void	 loadChunkMesh(Chunk& chunk, Engine::Renderer::CommandList& commands);
+	void	 loadCasterMesh(Chunk& chunk, Engine::Renderer::CommandList& commands);
+	void	 drawSolid(const Chunk& chunk, Engine::Renderer::CommandList& commands);
+	void	 drawTrans(const Chunk& chunk, Engine::Renderer::CommandList& commands);
+	void	 drawCaster(const Chunk& chunk, Engine::Renderer::CommandList& commands);
+	void	 disableChunk(Chunk& chunk, Engine::Renderer::BufferPool& pool);
+	bool	 acquireChunkBuffers(Chunk& chunk, Engine::Renderer::BufferPool& pool);
 }
@@ -0,0 +1,249 @@
+/**
+* Entities.
+*
+* An entity is only a slot with a generation, its data lives in component
+* pools that keep every field in its own dense array. Systems walk a pool
+* from front to back in batches on the job threads, a batch only writes
+* the components it owns, so no system needs a lock.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "../../engine/jobs/jobs.h"
+#include "../../engine/profiler/profiler.h"
+
+#include "../world/world.h"
+#include "../world/collision.h"
+
+#include "entity.h"
+
+using namespace GameModule;
+
+constexpr float g_entityGravity = 32.0f;
+constexpr float g_terminalVelocity = 60.0f;
+constexpr float g_entityStepHeight = 1.0f;
+constexpr float g_groundFriction = 0.01f; // Horizontal velocity left after a second on the ground
+constexpr float g_eyeHeight = 0.9f; // Of the body height
+
+struct EntitySystem
+{
+	const char*	name;
+	uint32_t	batchSize;
+	uint32_t	(*count)(const Entities& entities);
+	void		(*run)(const World& world, Entities& entities, float dt, uint32_t begin, uint32_t end);
+};
+
+template <typename T>
+void swapRemove(std::vector<T>& values, uint32_t index)
+{
+	values[index] = values.back();
+	values.pop_back();
+}
+
+Entity GameModule::createEntity(Entities& entities)
+{
+	uint32_t slot;
+	if (!entities.freeSlots.empty())
+	{
+		slot = entities.freeSlots.back();
+		entities.freeSlots.pop_back();
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(entities.generations.size());
+		entities.generations.push_back(0);
+		entities.body.push_back(g_noComponent);
+		entities.sight.push_back(g_noComponent);
+	}
+
+	entities.alive++;
+	return { slot, entities.generations[slot] };
+}
+
+void GameModule::destroyEntity(Entities& entities, Entity entity)
+{
+	if (!isAlive(entities, entity))
+	{
+		return;
+	}
+
+	removeBody(entities, entity);
+	removeSight(entities, entity);
+
+	entities.generations[entity.slot]++;
+	entities.freeSlots.push_back(entity.slot);
+	entities.alive--;
+}
+
+bool GameModule::isAlive(const Entities& entities, Entity entity)
+{
+	return entity.slot < entities.generations.size() &&
+		entities.generations[entity.slot] == entity.generation;
+}
+
+void GameModule::addBody(Entities& entities, Entity entity, const glm::vec3& pos, const glm::vec3& size)
+{
+	if (!isAlive(entities, entity) || entities.body[entity.slot] != g_noComponent)
+	{
+		return;
+	}
+
+	BodyPool& bodies = entities.bodies;
+	entities.body[entity.slot] = static_cast<uint32_t>(bodies.slots.size());
+	bodies.slots.push_back(entity.slot);
+	bodies.pos.push_back(pos);
+	bodies.velocity.push_back(glm::vec3(0.0f));
+	bodies.size.push_back(size);
+	bodies.onGround.push_back(false);
+}
+
+void GameModule::removeBody(Entities& entities, Entity entity)
+{
+	if (!isAlive(entities, entity) || entities.body[entity.slot] == g_noComponent)
+	{
+		return;
+	}
+
+	BodyPool& bodies = entities.bodies;
+	const uint32_t index = entities.body[entity.slot];
+	entities.body[bodies.slots.back()] = index;
+	entities.body[entity.slot] = g_noComponent;
+
+	swapRemove(bodies.slots, index);
+	swapRemove(bodies.pos, index);
+	swapRemove(bodies.velocity, index);
+	swapRemove(bodies.size, index);
+	swapRemove(bodies.onGround, index);
+}
+
+void GameModule::addSight(Entities& entities, Entity entity, const glm::vec3& dir, float range)
+{
+	if (!isAlive(entities, entity) || entities.sight[entity.slot] != g_noComponent)
+	{
+		return;
+	}
+
+	SightPool& sights = entities.sights;
+	entities.sight[entity.slot] = static_cast<uint32_t>(sights.slots.size());
+	sights.slots.push_back(entity.slot);
+	sights.dir.push_back(glm::normalize(dir));
+	sights.range.push_back(range);
+	sights.hitDistance.push_back(range);
+}
+
+void GameModule::removeSight(Entities& entities, Entity entity)
+{
+	if (!isAlive(entities, entity) || entities.sight[entity.slot] == g_noComponent)
+	{
+		return;
+	}
+
+	SightPool& sights = entities.sights;
+	const uint32_t index = entities.sight[entity.slot];
+	entities.sight[sights.slots.back()] = index;
+	entities.sight[entity.slot] = g_noComponent;
+
+	swapRemove(sights.slots, index);
+	swapRemove(sights.dir, index);
+	swapRemove(sights.range, index);
+	swapRemove(sights.hitDistance, index);
+}
+
+uint32_t countBodies(const Entities& entities)
+{
+	return static_cast<uint32_t>(entities.bodies.slots.size());
+}
+
+uint32_t countSights(const Entities& entities)
+{
+	return static_cast<uint32_t>(entities.sights.slots.size());
+}
+
+void applyGravity(const World&, Entities& entities, float dt, uint32_t begin, uint32_t end)
+{
+	glm::vec3* velocity = entities.bodies.velocity.data();
+	for (uint32_t i = begin; i < end; i++)
+	{
+		velocity[i].y = std::max(velocity[i].y - g_entityGravity * dt, -g_terminalVelocity);
+	}
+}
+
+void moveBodies(const World& world, Entities& entities, float dt, uint32_t begin, uint32_t end)
+{
+	BodyPool& bodies = entities.bodies;
+	const float friction = std::pow(g_groundFriction, dt);
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		glm::vec3& velocity = bodies.velocity[i];
+
+		AABB box = { bodies.pos[i], bodies.pos[i] + bodies.size[i] };
+		const CollisionResult result = moveAABB(world, box, velocity * dt, g_entityStepHeight);
+		bodies.pos[i] = box.min;
+		bodies.onGround[i] = result.onGround;
+
+		if (result.hitX)
+		{
+			velocity.x = 0.0f;
+		}
+		if (result.hitY)
+		{
+			velocity.y = 0.0f;
+		}
+		if (result.hitZ)
+		{
+			velocity.z = 0.0f;
+		}
+
+		if (result.onGround)
+		{
+			velocity.x *= friction;
+			velocity.z *= friction;
+		}
+	}
+}
+
+void castSights(const World& world, Entities& entities, float, uint32_t begin, uint32_t end)
+{
+	SightPool& sights = entities.sights;
+	const BodyPool& bodies = entities.bodies;
+
+	for (uint32_t i = begin; i < end; i++)
+	{
+		// Without a body there is nothing to look from
+		const uint32_t body = entities.body[sights.slots[i]];
+		if (body == g_noComponent)
+		{
+			sights.hitDistance[i] = sights.range[i];
+			continue;
+		}
+
+		const glm::vec3 size = bodies.size[body];
+		const glm::vec3 eye = bodies.pos[body] + glm::vec3(size.x * 0.5f, size.y * g_eyeHeight, size.z * 0.5f);
+
+		RaycastHit hit;
+		sights.hitDistance[i] = raycastBlocks(world, eye, sights.dir[i], sights.range[i], hit) ?
+			hit.distance : sights.range[i];
+	}
+}
+
+// In the order they run, a system sees everything the previous ones wrote
+static const EntitySystem g_entitySystems[] = {
+	{ "gravity",	4096,	countBodies,	applyGravity },
+	{ "collision",	256,	countBodies,	moveBodies },
+	{ "sight",		256,	countSights,	castSights },
+};
+
+void GameModule::updateEntities(const World& world, Entities& entities, float dt)
+{
+	PROFILE_SCOPE("updateEntities");
+
+	for (const EntitySystem& system : g_entitySystems)
+	{
+		Engine::parallelFor(system.name, system.count(entities), system.batchSize,
+			[&world, &entities, &system, dt](uint32_t begin, uint32_t end) {
+				system.run(world, entities, dt, begin, end);
+			});
+	}
+}
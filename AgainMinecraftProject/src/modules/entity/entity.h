@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GameModule
+{
+	struct World;
+
+	constexpr uint32_t g_noComponent = 0xFFFFFFFF;
+
+	// The generation changes every time the slot is reused, so stale handles don't match
+	struct Entity
+	{
+		uint32_t slot;
+		uint32_t generation;
+	};
+
+	// Component pools keep one dense array per field, systems walk them front to back.
+	// Removing a component moves the last one into its place.
+	struct BodyPool
+	{
+		std::vector<uint32_t>	slots;
+		std::vector<glm::vec3>	pos; // Min corner of the box
+		std::vector<glm::vec3>	velocity;
+		std::vector<glm::vec3>	size;
+		std::vector<uint8_t>	onGround;
+	};
+
+	// A ray from the top of the body, hitDistance is the range when it hits nothing
+	struct SightPool
+	{
+		std::vector<uint32_t>	slots;
+		std::vector<glm::vec3>	dir;
+		std::vector<float>		range;
+		std::vector<float>		hitDistance;
+	};
+
+	struct Entities
+	{
+		// Per slot, where its components are in the pools
+		std::vector<uint32_t>	generations;
+		std::vector<uint32_t>	body;
+		std::vector<uint32_t>	sight;
+		std::vector<uint32_t>	freeSlots;
+		uint32_t				alive = 0;
+
+		BodyPool				bodies;
+		SightPool				sights;
+	};
+
+	Entity createEntity(Entities& entities);
+	void destroyEntity(Entities& entities, Entity entity);
+	bool isAlive(const Entities& entities, Entity entity);
+
+	void addBody(Entities& entities, Entity entity, const glm::vec3& pos, const glm::vec3& size);
+	void removeBody(Entities& entities, Entity entity);
+	void addSight(Entities& entities, Entity entity, const glm::vec3& dir, float range);
+	void removeSight(Entities& entities, Entity entity);
+
+	// Runs gravity, collision and sight one after another, each of them
+	// split over the job threads. Only entities may change while it runs.
+	void updateEntities(const World& world, Entities& entities, float dt);
+}
@@ -0,0 +1,73 @@
+/**
+* Shadow caster lists per cascade.
+*
+* Instead of amplifying every triangle into every cascade layer,
+* each cascade gets only the chunks whose bounds overlap
+* its light space box and whose shadow can fall on a section
+* the visibility search reached. Everything here is CPU only.
+*/
+
+#include <limits>
+
+#include "../chunk/chunk.h"
+
+#include "world.h"
+#include "cascade.h"
+
+using namespace GameModule;
+
+constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
+
+bool GameModule::isAABBInCascade(const glm::mat4& lightSpaceMatrix, const glm::vec3& min, const glm::vec3& max)
+{
+	glm::vec3 lsMin = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 lsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		const glm::vec3 corner = {
+			i & 1 ? max.x : min.x,
+			i & 2 ? max.y : min.y,
+			i & 4 ? max.z : min.z
+		};
+
+		// Light projection is orthographic so w stays 1
+		const glm::vec3 lsCorner = glm::vec3(lightSpaceMatrix * glm::vec4(corner, 1.0f));
+		lsMin = glm::min(lsMin, lsCorner);
+		lsMax = glm::max(lsMax, lsCorner);
+	}
+
+	return
+		lsMax.x >= -1.0f && lsMin.x <= 1.0f &&
+		lsMax.y >= -1.0f && lsMin.y <= 1.0f &&
+		lsMax.z >= -1.0f && lsMin.z <= 1.0f;
+}
+
+void GameModule::buildCascadeCasterLists(World& world, const glm::mat4* lightSpaceMatrices, uint32_t nMatrices)
+{
+	world.cascadeCasters.resize(nMatrices);
+	for (auto& casters : world.cascadeCasters)
+	{
+		casters.clear();
+	}
+
+	for (auto& pair : world.chunks)
+	{
+		Chunk& chunk = pair.second;
+		if (chunk.minSolidY > chunk.maxSolidY || !chunk.shadowVisible)
+		{
+			continue;
+		}
+
+		const glm::vec3 min = { chunk.pos.x, chunk.minSolidY, chunk.pos.z };
+		const glm::vec3 max = { chunk.pos.x + g_chunkSize.x, chunk.maxSolidY, chunk.pos.z + g_chunkSize.z };
+
+		for (uint32_t layer = 0; layer < nMatrices; layer++)
+		{
+			if (isAABBInCascade(lightSpaceMatrices[layer], min, max))
+			{
+				world.cascadeCasters[layer].push_back(&chunk);
+			}
+		}
+	}
+}
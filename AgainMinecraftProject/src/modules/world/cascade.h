@@ -0,0 +1,13 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace GameModule
+{
+	struct World;
+
+	bool isAABBInCascade(const glm::mat4& lightSpaceMatrix, const glm::vec3& min, const glm::vec3& max);
+	void buildCascadeCasterLists(World& world, const glm::mat4* lightSpaceMatrices, uint32_t nMatrices);
+}
@@ -0,0 +1,332 @@
+/**
+* Voxel collision.
+*
+* Every chunk keeps a bitmask of its solid blocks on the simulation side.
+* A query looks up each chunk under the swept volume once, collects the
+* solid blocks from the bitmask and then sweeps the box axis by axis
+* against that list, so there are no map lookups per block.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "../chunk/chunk.h"
+#include "../player/player.h"
+
+#include "world.h"
+#include "collision.h"
+
+using namespace GameModule;
+
+constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
+
+constexpr float g_skin = 0.001f; // Kept between the box and a block it stopped at
+constexpr float g_groundProbe = 0.01f;
+constexpr float g_playerStepHeight = 1.0f; // Every step is a full block
+
+// Solid blocks under the swept volume of the current query, reused between queries
+static thread_local std::vector<glm::ivec3> t_candidates;
+
+inline uint32_t getBlockId(int32_t x, int32_t y, int32_t z)
+{
+	return g_chunkSize.x * (y * g_chunkSize.z + z) + x;
+}
+
+inline int32_t floorDiv(int32_t a, int32_t b)
+{
+	return a >= 0 ? a / b : (a - b + 1) / b;
+}
+
+void GameModule::buildSolidMask(SolidMask& mask, const Chunk& chunk)
+{
+	mask.bits.fill(0);
+	for (uint32_t id = 0; id < chunk.blocks.size(); id++)
+	{
+		if (isSolidBlock(chunk.blocks[id].type))
+		{
+			mask.bits[id >> 6] |= uint64_t(1) << (id & 63);
+		}
+	}
+	mask.heights = chunk.heights.opaque;
+}
+
+int32_t GameModule::getGroundHeight(const World& world, int32_t x, int32_t z)
+{
+	const glm::ivec3 chunkPos = {
+		floorDiv(x, g_chunkSize.x) * g_chunkSize.x, 0,
+		floorDiv(z, g_chunkSize.z) * g_chunkSize.z };
+
+	auto it = world.solidity.find(chunkPos);
+	if (it == world.solidity.end())
+	{
+		return -1;
+	}
+	return it->second.heights[g_chunkSize.x * (z - chunkPos.z) + x - chunkPos.x];
+}
+
+bool GameModule::isSolid(const World& world, const glm::ivec3& pos)
+{
+	if (pos.y < 0 || pos.y >= g_chunkSize.y)
+	{
+		return false;
+	}
+
+	const glm::ivec3 chunkPos = {
+		floorDiv(pos.x, g_chunkSize.x) * g_chunkSize.x, 0,
+		floorDiv(pos.z, g_chunkSize.z) * g_chunkSize.z };
+
+	auto it = world.solidity.find(chunkPos);
+	if (it == world.solidity.end())
+	{
+		return false;
+	}
+
+	const uint32_t id = getBlockId(pos.x - chunkPos.x, pos.y, pos.z - chunkPos.z);
+	return (it->second.bits[id >> 6] >> (id & 63)) & 1;
+}
+
+// Fills t_candidates with every solid block touching the given bounds
+void gatherCandidates(const World& world, const AABB& bounds)
+{
+	t_candidates.clear();
+
+	const glm::ivec3 min = glm::floor(bounds.min);
+	const glm::ivec3 max = glm::ivec3(glm::floor(bounds.max));
+	const int32_t minY = std::max(min.y, 0);
+	const int32_t maxY = std::min(max.y, g_chunkSize.y - 1);
+
+	for (int32_t chunkZ = floorDiv(min.z, g_chunkSize.z); chunkZ <= floorDiv(max.z, g_chunkSize.z); chunkZ++)
+	{
+		for (int32_t chunkX = floorDiv(min.x, g_chunkSize.x); chunkX <= floorDiv(max.x, g_chunkSize.x); chunkX++)
+		{
+			const glm::ivec3 chunkPos = { chunkX * g_chunkSize.x, 0, chunkZ * g_chunkSize.z };
+			auto it = world.solidity.find(chunkPos);
+			if (it == world.solidity.end())
+			{
+				continue;
+			}
+
+			const SolidMask& mask = it->second;
+			const int32_t x0 = std::max(min.x - chunkPos.x, 0);
+			const int32_t x1 = std::min(max.x - chunkPos.x, g_chunkSize.x - 1);
+			const int32_t z0 = std::max(min.z - chunkPos.z, 0);
+			const int32_t z1 = std::min(max.z - chunkPos.z, g_chunkSize.z - 1);
+
+			for (int32_t y = minY; y <= maxY; y++)
+			{
+				for (int32_t z = z0; z <= z1; z++)
+				{
+					for (int32_t x = x0; x <= x1; x++)
+					{
+						const uint32_t id = getBlockId(x, y, z);
+						if ((mask.bits[id >> 6] >> (id & 63)) & 1)
+						{
+							t_candidates.push_back({ chunkPos.x + x, y, chunkPos.z + z });
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+// Clips the move along one axis against the candidates, returns how far the box got
+float sweepAxis(AABB& box, uint32_t axis, float delta)
+{
+	const uint32_t u = (axis + 1) % 3;
+	const uint32_t v = (axis + 2) % 3;
+
+	float allowed = delta;
+	for (const glm::ivec3& block : t_candidates)
+	{
+		// Only blocks overlapping the box on the other two axes can stop it
+		if (box.max[u] <= block[u] + g_skin || box.min[u] >= block[u] + 1 - g_skin ||
+			box.max[v] <= block[v] + g_skin || box.min[v] >= block[v] + 1 - g_skin)
+		{
+			continue;
+		}
+
+		if (delta > 0.0f && box.max[axis] <= block[axis] + g_skin)
+		{
+			allowed = std::min(allowed, block[axis] - box.max[axis] - g_skin);
+		}
+		else if (delta < 0.0f && box.min[axis] >= block[axis] + 1 - g_skin)
+		{
+			allowed = std::max(allowed, block[axis] + 1 - box.min[axis] + g_skin);
+		}
+	}
+
+	// Already touching, never pushed backwards
+	allowed = delta > 0.0f ? std::max(allowed, 0.0f) : std::min(allowed, 0.0f);
+
+	box.min[axis] += allowed;
+	box.max[axis] += allowed;
+	return allowed;
+}
+
+CollisionResult sweepBox(AABB& box, const glm::vec3& delta)
+{
+	CollisionResult result = {};
+
+	// Vertical first, so walking on the ground doesn't catch on the blocks below
+	for (uint32_t axis : { 1, 0, 2 })
+	{
+		if (delta[axis] != 0.0f)
+		{
+			result.moved[axis] = sweepAxis(box, axis, delta[axis]);
+		}
+	}
+
+	result.hitX = result.moved.x != delta.x;
+	result.hitY = result.moved.y != delta.y;
+	result.hitZ = result.moved.z != delta.z;
+	result.onGround = result.hitY && delta.y < 0.0f;
+	return result;
+}
+
+// A candidate right under the footprint of the box
+bool touchesGround(const AABB& box)
+{
+	for (const glm::ivec3& block : t_candidates)
+	{
+		const float top = block.y + 1.0f;
+		if (box.min.y >= top - g_skin && box.min.y <= top + g_groundProbe &&
+			box.max.x > block.x + g_skin && box.min.x < block.x + 1 - g_skin &&
+			box.max.z > block.z + g_skin && box.min.z < block.z + 1 - g_skin)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+CollisionResult GameModule::moveAABB(const World& world, AABB& box, const glm::vec3& delta, float stepHeight)
+{
+	// Everything the box could touch, a step up and the ground under it included
+	const AABB bounds = {
+		glm::min(box.min, box.min + delta) - glm::vec3(0.0f, g_groundProbe, 0.0f),
+		glm::max(box.max, box.max + delta) + glm::vec3(0.0f, stepHeight, 0.0f) };
+	gatherCandidates(world, bounds);
+
+	const bool grounded = touchesGround(box);
+
+	const AABB start = box;
+	CollisionResult result = sweepBox(box, delta);
+
+	if (grounded && stepHeight > 0.0f && (result.hitX || result.hitZ))
+	{
+		AABB stepped = start;
+		CollisionResult step = {};
+		const float up = sweepAxis(stepped, 1, stepHeight);
+		step.moved.x = sweepAxis(stepped, 0, delta.x);
+		step.moved.z = sweepAxis(stepped, 2, delta.z);
+		const float drop = -up + std::min(delta.y, 0.0f);
+		const float down = sweepAxis(stepped, 1, drop);
+		step.moved.y = up + down;
+
+		// Taken only if it gets further than walking into the wall
+		const glm::vec2 walked = { result.moved.x, result.moved.z };
+		const glm::vec2 climbed = { step.moved.x, step.moved.z };
+		if (glm::dot(climbed, climbed) > glm::dot(walked, walked))
+		{
+			box = stepped;
+			step.hitX = step.moved.x != delta.x;
+			step.hitZ = step.moved.z != delta.z;
+			step.hitY = down != drop;
+			step.stepped = true;
+			result = step;
+		}
+	}
+
+	result.onGround = result.onGround || touchesGround(box);
+	return result;
+}
+
+bool GameModule::isOnGround(const World& world, const AABB& box)
+{
+	gatherCandidates(world, {
+		glm::vec3(box.min.x, box.min.y - g_groundProbe, box.min.z),
+		glm::vec3(box.max.x, box.min.y, box.max.z) });
+	return touchesGround(box);
+}
+
+bool GameModule::raycastBlocks(const World& world, const glm::vec3& origin, const glm::vec3& dir, float maxDistance, RaycastHit& hit)
+{
+	glm::ivec3 block = glm::floor(origin);
+	const glm::ivec3 step = glm::sign(dir);
+
+	// Distance along the ray to the next block boundary and between two of them, per axis
+	glm::vec3 next;
+	glm::vec3 delta;
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		delta[axis] = dir[axis] != 0.0f ? std::abs(1.0f / dir[axis]) : std::numeric_limits<float>::infinity();
+		const float boundary = step[axis] > 0 ? block[axis] + 1.0f : static_cast<float>(block[axis]);
+		next[axis] = dir[axis] != 0.0f ? (boundary - origin[axis]) / dir[axis] : std::numeric_limits<float>::infinity();
+	}
+
+	// The chunk of the last block, walking within one chunk needs no lookups
+	glm::ivec3 chunkPos = glm::ivec3(std::numeric_limits<int32_t>::max());
+	const SolidMask* mask = nullptr;
+
+	glm::ivec3 normal = glm::ivec3(0);
+	float distance = 0.0f;
+	while (distance <= maxDistance)
+	{
+		if (block.y >= 0 && block.y < g_chunkSize.y)
+		{
+			const glm::ivec3 blockChunk = {
+				floorDiv(block.x, g_chunkSize.x) * g_chunkSize.x, 0,
+				floorDiv(block.z, g_chunkSize.z) * g_chunkSize.z };
+			if (blockChunk != chunkPos)
+			{
+				chunkPos = blockChunk;
+				auto it = world.solidity.find(chunkPos);
+				mask = it != world.solidity.end() ? &it->second : nullptr;
+			}
+
+			const uint32_t id = getBlockId(block.x - chunkPos.x, block.y, block.z - chunkPos.z);
+			if (mask && (mask->bits[id >> 6] >> (id & 63)) & 1)
+			{
+				hit.block = block;
+				hit.normal = normal;
+				hit.distance = distance;
+				return true;
+			}
+		}
+
+		const uint32_t axis = next.x < next.y ? (next.x < next.z ? 0 : 2) : (next.y < next.z ? 1 : 2);
+		distance = next[axis];
+		next[axis] += delta[axis];
+		block[axis] += step[axis];
+		normal = glm::ivec3(0);
+		normal[axis] = -step[axis];
+	}
+	return false;
+}
+
+CollisionResult GameModule::movePlayer(World& world, Player& player, float dt)
+{
+	AABB box = { player.pos, player.pos + player.size };
+	const CollisionResult result = moveAABB(world, box, player.velocity * dt, g_playerStepHeight);
+
+	player.camera.pos += box.min - player.pos;
+	player.pos = box.min;
+
+	// Blocked axes lose their speed, otherwise it builds up against the wall
+	if (result.hitX)
+	{
+		player.velocity.x = 0.0f;
+	}
+	if (result.hitY)
+	{
+		player.velocity.y = 0.0f;
+	}
+	if (result.hitZ)
+	{
+		player.velocity.z = 0.0f;
+	}
+	return result;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+namespace GameModule
+{
+	struct World;
+	struct Chunk;
+	struct Player;
+
+	constexpr uint32_t g_solidMaskWords = 16 * 256 * 16 / 64;
+
+	// One bit per block, in the block order of the chunk, set for blocks nothing can pass through
+	struct SolidMask
+	{
+		std::array<uint64_t, g_solidMaskWords>	bits;
+		std::array<uint16_t, 16 * 16>			heights; // Per column, right above the highest solid block
+	};
+
+	struct AABB
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	struct RaycastHit
+	{
+		glm::ivec3	block;
+		glm::ivec3	normal; // Face of the block the ray went through
+		float		distance;
+	};
+
+	struct CollisionResult
+	{
+		glm::vec3	moved;
+		bool		hitX;
+		bool		hitY;
+		bool		hitZ;
+		bool		onGround;
+		bool		stepped;
+	};
+
+	void buildSolidMask(SolidMask& mask, const Chunk& chunk);
+	bool isSolid(const World& world, const glm::ivec3& pos);
+
+	// Simulation thread, where a body dropped into the column lands, -1 when the chunk isn't loaded
+	int32_t getGroundHeight(const World& world, int32_t x, int32_t z);
+
+	// Moves the box one axis at a time against the solid blocks of the world,
+	// a blocked horizontal move is retried up to stepHeight higher when standing
+	CollisionResult moveAABB(const World& world, AABB& box, const glm::vec3& delta, float stepHeight);
+	bool isOnGround(const World& world, const AABB& box);
+
+	// Walks the blocks along the ray, dir has to be normalized
+	bool raycastBlocks(const World& world, const glm::vec3& origin, const glm::vec3& dir, float maxDistance, RaycastHit& hit);
+
+	CollisionResult movePlayer(World& world, Player& player, float dt);
+}
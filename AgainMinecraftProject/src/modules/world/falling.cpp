@@ -0,0 +1,199 @@
+/**
+* Falling blocks.
+*
+* Nothing is ticked per block. An edit only queues its column, and once per
+* frame every queued column is read bottom to top and each stretch between two
+* supporting blocks is compacted, falling blocks to the bottom and the air or
+* water they fell through above them. Only the blocks that differ are written
+* back, so a carved out beach settles in a single pass.
+*/
+
+#include <algorithm>
+
+#include "../../engine/jobs/jobs.h"
+#include "../../engine/profiler/profiler.h"
+
+#include "../chunk/chunk.h"
+
+#include "world.h"
+#include "falling.h"
+
+using namespace GameModule;
+
+constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
+
+struct QueuedColumns
+{
+	glm::ivec3	pos;
+	Chunk*		chunk;
+	ColumnSet*	columns;
+};
+
+static std::vector<QueuedColumns> g_queuedColumns;
+
+inline uint32_t getBlockId(uint32_t x, uint32_t y, uint32_t z)
+{
+	return g_chunkSize.x * (y * g_chunkSize.z + z) + x;
+}
+
+inline bool isSupport(const Block& block)
+{
+	return isSolidBlock(block.type) && !isFallingBlock(block.type);
+}
+
+void GameModule::queueColumn(World& world, const glm::ivec3& pos)
+{
+	const glm::ivec3 chunkPos = getChunkOrigin(pos);
+	const uint32_t column = g_chunkSize.x * (pos.z - chunkPos.z) + pos.x - chunkPos.x;
+
+	ColumnSet& columns = world.unsettled[chunkPos];
+	columns.queued[column >> 6] |= uint64_t(1) << (column & 63);
+}
+
+void settleColumn(const Chunk& chunk, uint32_t x, uint32_t z, std::vector<BlockWrite>& writes)
+{
+	std::array<Block, g_chunkSize.y> column;
+	bool falling = false;
+	for (uint32_t y = 0; y < g_chunkSize.y; y++)
+	{
+		column[y] = chunk.blocks[getBlockId(x, y, z)];
+		falling = falling || isFallingBlock(column[y].type);
+	}
+
+	if (!falling)
+	{
+		return;
+	}
+
+	// Compacted per stretch between supports, the order within falling and within
+	// passable blocks stays, so sand keeps its layers and water its levels
+	std::array<Block, g_chunkSize.y> settled;
+	uint32_t start = 0;
+	for (uint32_t y = 0; y <= g_chunkSize.y; y++)
+	{
+		if (y < g_chunkSize.y && !isSupport(column[y]))
+		{
+			continue;
+		}
+
+		uint32_t out = start;
+		for (uint32_t i = start; i < y; i++)
+		{
+			if (isFallingBlock(column[i].type))
+			{
+				settled[out++] = column[i];
+			}
+		}
+		for (uint32_t i = start; i < y; i++)
+		{
+			if (!isFallingBlock(column[i].type))
+			{
+				settled[out++] = column[i];
+			}
+		}
+
+		if (y < g_chunkSize.y)
+		{
+			settled[y] = column[y];
+		}
+		start = y + 1;
+	}
+
+	// The light stays with the cell, whatever falls through it
+	for (uint32_t y = 0; y < g_chunkSize.y; y++)
+	{
+		setBlockLight(settled[y], getBlockLight(column[y]));
+	}
+
+	for (uint32_t y = 0; y < g_chunkSize.y; y++)
+	{
+		if (settled[y].type != column[y].type || settled[y].data != column[y].data)
+		{
+			writes.push_back({ getBlockId(x, y, z), settled[y] });
+		}
+	}
+}
+
+void settleChunk(QueuedColumns& queued)
+{
+	ColumnSet& columns = *queued.columns;
+	for (uint32_t column = 0; column < g_chunkSize.x * g_chunkSize.z; column++)
+	{
+		if (columns.queued[column >> 6] >> (column & 63) & 1)
+		{
+			settleColumn(*queued.chunk, column % g_chunkSize.x, column / g_chunkSize.x, columns.writes);
+		}
+	}
+	columns.queued.fill(0);
+}
+
+SettlePass GameModule::settleColumns(World& world)
+{
+	SettlePass pass = {};
+	if (world.unsettled.empty())
+	{
+		return pass;
+	}
+
+	PROFILE_SCOPE("settleColumns");
+
+	g_queuedColumns.clear();
+	for (auto it = world.unsettled.begin(); it != world.unsettled.end();)
+	{
+		auto chunk = world.chunks.find(it->first);
+		if (chunk == world.chunks.end())
+		{
+			it = world.unsettled.erase(it);
+			continue;
+		}
+
+		for (uint64_t word : it->second.queued)
+		{
+			for (; word; word &= word - 1) // Clears the lowest bit
+			{
+				pass.columns++;
+			}
+		}
+		g_queuedColumns.push_back({ it->first, &chunk->second, &it->second });
+		++it;
+	}
+	pass.chunks = static_cast<uint32_t>(g_queuedColumns.size());
+
+	// Columns never cross chunks, every chunk only reads its own blocks
+	Engine::parallelFor("settleChunk", pass.chunks, 1, [](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			settleChunk(g_queuedColumns[i]);
+		}
+	});
+
+	// Writing queues the columns again, the next pass finds them settled and drops them
+	for (QueuedColumns& queued : g_queuedColumns)
+	{
+		for (const BlockWrite& write : queued.columns->writes)
+		{
+			const glm::ivec3 local = {
+				write.id % g_chunkSize.x,
+				write.id / (g_chunkSize.x * g_chunkSize.z),
+				write.id / g_chunkSize.x % g_chunkSize.z };
+			setBlock(world, queued.pos + local, write.block);
+		}
+		pass.moved += static_cast<uint32_t>(queued.columns->writes.size());
+		queued.columns->writes.clear();
+	}
+
+	for (auto it = world.unsettled.begin(); it != world.unsettled.end();)
+	{
+		const std::array<uint64_t, g_columnWords>& queued = it->second.queued;
+		if (std::all_of(queued.begin(), queued.end(), [](uint64_t word) { return word == 0; }))
+		{
+			it = world.unsettled.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	return pass;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../chunk/block.h"
+
+namespace GameModule
+{
+	struct World;
+
+	constexpr uint32_t g_columnWords = 16 * 16 / 64;
+
+	// Columns of a chunk that may hold a falling block without support
+	struct ColumnSet
+	{
+		std::array<uint64_t, g_columnWords>	queued = {};
+		std::vector<BlockWrite>				writes; // Scratch of the running pass
+	};
+
+	struct SettlePass
+	{
+		uint32_t chunks;
+		uint32_t columns;
+		uint32_t moved; // Blocks written back
+	};
+
+	// setBlock queues the column when a falling block is placed or loses its support
+	void queueColumn(World& world, const glm::ivec3& pos);
+
+	// Every queued column drops its falling blocks onto the next solid one in a single pass,
+	// the writes go through setBlock, so each edited chunk is remeshed once
+	SettlePass settleColumns(World& world);
+}
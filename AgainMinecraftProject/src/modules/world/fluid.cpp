@@ -0,0 +1,284 @@
+/**
+* Water flow.
+*
+* Only cells next to a change are queued, per chunk and section, so still
+* water costs nothing. A step works out the new state of every queued cell
+* from the blocks around it as they were at the start of the step, which
+* lets the chunks run in parallel and gives the same result at chunk borders
+* no matter which thread gets there first. The writes are applied afterwards
+* in chunk order and queue the cells around them for the next step.
+*/
+
+#include <algorithm>
+
+#include "../../engine/jobs/jobs.h"
+#include "../../engine/profiler/profiler.h"
+
+#include "../chunk/chunk.h"
+
+#include "world.h"
+#include "fluid.h"
+
+using namespace GameModule;
+
+constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
+
+constexpr float g_fluidStepTime = 0.25f;
+
+const glm::ivec3 g_fluidSides[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+struct ActiveFluids
+{
+	glm::ivec3	pos;
+	Chunk*		chunk;
+	FluidChunk*	fluids;
+};
+
+static std::vector<ActiveFluids> g_activeFluids;
+
+// Keeps the chunk of the last read, most reads stay within it
+struct BlockReader
+{
+	const World&	world;
+	glm::ivec3		chunkPos;
+	const Chunk*	chunk;
+};
+
+inline uint32_t getBlockId(const glm::ivec3& pos)
+{
+	return g_chunkSize.x * (pos.y * g_chunkSize.z + pos.z) + pos.x;
+}
+
+inline glm::ivec3 getBlockPos(uint32_t id)
+{
+	return { id % g_chunkSize.x, id / (g_chunkSize.x * g_chunkSize.z), id / g_chunkSize.x % g_chunkSize.z };
+}
+
+inline bool isWater(const Block& block)
+{
+	return block.type == BlockType::WATER;
+}
+
+inline bool isSource(const Block& block)
+{
+	return isWater(block) && getFluidLevel(block) == 0;
+}
+
+inline Block withFluid(Block block, BlockType type, uint8_t level)
+{
+	block.type = type;
+	block.data = (block.data & ~g_fluidLevelMask) | level;
+	return block;
+}
+
+Block readBlock(BlockReader& reader, const glm::ivec3& pos)
+{
+	// Nothing flows out of the bottom of the world or into chunks that aren't loaded
+	if (pos.y < 0)
+	{
+		return { BlockType::STONE, 0 };
+	}
+	if (pos.y >= g_chunkSize.y)
+	{
+		return { BlockType::AIR, 0 };
+	}
+
+	const glm::ivec3 chunkPos = getChunkOrigin(pos);
+	if (chunkPos != reader.chunkPos)
+	{
+		auto it = reader.world.chunks.find(chunkPos);
+		reader.chunkPos = chunkPos;
+		reader.chunk = it != reader.world.chunks.end() ? &it->second : nullptr;
+	}
+
+	if (!reader.chunk)
+	{
+		return { BlockType::STONE, 0 };
+	}
+	return reader.chunk->blocks[getBlockId(pos - chunkPos)];
+}
+
+// Falling water spreads like a source once it lands,
+// sideways it only spreads from water that can't fall
+Block flowInto(BlockReader& reader, const glm::ivec3& pos, const Block& block)
+{
+	if (isSolidBlock(block.type) || isSource(block))
+	{
+		return block;
+	}
+
+	if (isWater(readBlock(reader, pos + glm::ivec3(0, 1, 0))))
+	{
+		return withFluid(block, BlockType::WATER, 1);
+	}
+
+	uint8_t level = g_maxFluidLevel + 1;
+	for (const glm::ivec3& side : g_fluidSides)
+	{
+		const Block neighbour = readBlock(reader, pos + side);
+		if (!isWater(neighbour))
+		{
+			continue;
+		}
+
+		const Block below = readBlock(reader, pos + side - glm::ivec3(0, 1, 0));
+		if (isSolidBlock(below.type) || isSource(below))
+		{
+			level = std::min<uint8_t>(level, getFluidLevel(neighbour) + 1);
+		}
+	}
+
+	return level <= g_maxFluidLevel ?
+		withFluid(block, BlockType::WATER, level) :
+		withFluid(block, BlockType::AIR, 0);
+}
+
+void queueCell(World& world, const glm::ivec3& pos)
+{
+	if (pos.y < 0 || pos.y >= g_chunkSize.y)
+	{
+		return;
+	}
+
+	const glm::ivec3 chunkPos = getChunkOrigin(pos);
+	auto chunk = world.chunks.find(chunkPos);
+	const uint32_t id = getBlockId(pos - chunkPos);
+	if (chunk == world.chunks.end() || isSolidBlock(chunk->second.blocks[id].type))
+	{
+		return;
+	}
+
+	FluidChunk& fluids = world.fluids[chunkPos];
+	const uint32_t section = id / g_sectionBlocks;
+	const uint32_t cell = id % g_sectionBlocks;
+
+	FluidSection& queue = fluids.sections[section];
+	const uint64_t bit = uint64_t(1) << (cell & 63);
+	if (queue.queued[cell >> 6] & bit)
+	{
+		return;
+	}
+
+	queue.queued[cell >> 6] |= bit;
+	queue.cells.push_back(static_cast<uint16_t>(cell));
+	fluids.activeSections |= 1 << section;
+}
+
+void GameModule::activateFluids(World& world, const glm::ivec3& pos)
+{
+	const glm::ivec3 up = { 0, 1, 0 };
+
+	// The block itself, the ones above and below and the sides of it and of the one above,
+	// those read whether this block holds water or lets it fall
+	queueCell(world, pos);
+	queueCell(world, pos + up);
+	queueCell(world, pos - up);
+	for (const glm::ivec3& side : g_fluidSides)
+	{
+		queueCell(world, pos + side);
+		queueCell(world, pos + side + up);
+	}
+}
+
+// Moves the queued cells into the step, cells queued from now on wait for the next one
+void takeQueuedCells(FluidChunk& fluids)
+{
+	for (uint32_t section = 0; section < g_sectionsPerChunk; section++)
+	{
+		if (!(fluids.activeSections & (1 << section)))
+		{
+			continue;
+		}
+
+		FluidSection& queue = fluids.sections[section];
+		for (uint16_t cell : queue.cells)
+		{
+			fluids.cells.push_back(section * g_sectionBlocks + cell);
+		}
+		queue.cells.clear();
+		queue.queued.fill(0);
+	}
+	fluids.activeSections = 0;
+}
+
+void flowChunk(const World& world, ActiveFluids& active)
+{
+	BlockReader reader = { world, active.pos, active.chunk };
+
+	FluidChunk& fluids = *active.fluids;
+	for (uint32_t id : fluids.cells)
+	{
+		const Block& block = active.chunk->blocks[id];
+		const Block flowed = flowInto(reader, active.pos + getBlockPos(id), block);
+		if (flowed.type != block.type || flowed.data != block.data)
+		{
+			fluids.writes.push_back({ id, flowed });
+		}
+	}
+	fluids.cells.clear();
+}
+
+FluidStep GameModule::stepFluids(World& world)
+{
+	PROFILE_SCOPE("stepFluids");
+
+	FluidStep step = {};
+
+	g_activeFluids.clear();
+	for (auto it = world.fluids.begin(); it != world.fluids.end();)
+	{
+		auto chunk = world.chunks.find(it->first);
+		if (chunk == world.chunks.end())
+		{
+			it = world.fluids.erase(it);
+			continue;
+		}
+
+		FluidChunk& fluids = it->second;
+		if (fluids.activeSections)
+		{
+			takeQueuedCells(fluids);
+			step.cells += static_cast<uint32_t>(fluids.cells.size());
+			g_activeFluids.push_back({ it->first, &chunk->second, &fluids });
+		}
+		++it;
+	}
+
+	// The map order depends on its history, writes are applied in chunk order
+	std::sort(g_activeFluids.begin(), g_activeFluids.end(), [](const ActiveFluids& a, const ActiveFluids& b) {
+		return a.pos.x < b.pos.x || (a.pos.x == b.pos.x && a.pos.z < b.pos.z);
+	});
+	step.chunks = static_cast<uint32_t>(g_activeFluids.size());
+
+	Engine::parallelFor("flowChunk", step.chunks, 1, [&world](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			flowChunk(world, g_activeFluids[i]);
+		}
+	});
+
+	for (ActiveFluids& active : g_activeFluids)
+	{
+		for (const BlockWrite& write : active.fluids->writes)
+		{
+			setBlock(world, active.pos + getBlockPos(write.id), write.block);
+		}
+		step.changed += static_cast<uint32_t>(active.fluids->writes.size());
+		active.fluids->writes.clear();
+	}
+
+	return step;
+}
+
+void GameModule::updateFluids(World& world, float dt)
+{
+	world.fluidTime += dt;
+	if (world.fluidTime < g_fluidStepTime)
+	{
+		return;
+	}
+
+	// A slow frame runs a single step, the water slows down instead of piling up work
+	world.fluidTime = std::min(world.fluidTime - g_fluidStepTime, g_fluidStepTime);
+	stepFluids(world);
+}
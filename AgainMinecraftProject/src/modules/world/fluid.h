@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../chunk/block.h"
+
+namespace GameModule
+{
+	struct World;
+
+	constexpr uint32_t g_sectionHeight = 16;
+	constexpr uint32_t g_sectionsPerChunk = 256 / g_sectionHeight;
+	constexpr uint32_t g_sectionBlocks = 16 * 16 * g_sectionHeight;
+
+	// Water keeps how far it is from its source in the low bits of the block data,
+	// sources are 0 and flowing water dries up past the max level
+	constexpr uint8_t g_fluidLevelMask = 0x0F;
+	constexpr uint8_t g_maxFluidLevel = 7;
+
+	// Cells queued for the next step, each of them at most once
+	struct FluidSection
+	{
+		std::vector<uint16_t>							cells;
+		std::array<uint64_t, g_sectionBlocks / 64>		queued = {};
+	};
+
+	struct FluidChunk
+	{
+		std::array<FluidSection, g_sectionsPerChunk>	sections;
+		uint32_t										activeSections = 0; // Bit per section with queued cells
+
+		// Scratch of the running step, the cells taken out of the sections and what they turn into
+		std::vector<uint32_t>							cells;
+		std::vector<BlockWrite>							writes;
+	};
+
+	struct FluidStep
+	{
+		uint32_t chunks;
+		uint32_t cells;
+		uint32_t changed;
+	};
+
+	inline uint8_t getFluidLevel(const Block& block)
+	{
+		return block.data & g_fluidLevelMask;
+	}
+
+	// Queues the blocks whose flow depends on the given one
+	void activateFluids(World& world, const glm::ivec3& pos);
+
+	// Steps at a fixed rate, the chunks it edits wait for remeshEditedChunks
+	void updateFluids(World& world, float dt);
+	FluidStep stepFluids(World& world);
+}
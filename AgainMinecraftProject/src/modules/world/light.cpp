@@ -0,0 +1,236 @@
+/**
+* Block light.
+*
+* Every cell keeps a light level in the high bits of its block data. A light
+* floods outwards breadth first through everything that isn't solid, a level
+* less with every step. Taking light away floods a second time, clearing the
+* cells the old light reached and queueing the ones at the edge that are lit
+* from elsewhere, which then fill the hole again. An edit never visits more
+* than the cells its light could reach, whatever else is lit around it.
+*/
+
+#include <array>
+#include <vector>
+
+#include "../chunk/chunk.h"
+
+#include "world.h"
+#include "light.h"
+
+using namespace GameModule;
+
+constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
+
+// Chunks around the edited one a cursor keeps, light never reaches past the next one
+// and remeshing the borders of those touches the ones after them
+constexpr int32_t g_cursorReach = 2;
+constexpr int32_t g_cursorWidth = 2 * g_cursorReach + 1;
+
+// About the cells a full light reaches, so the queues don't grow during the first edits
+constexpr size_t g_lightQueueSize = 4096;
+
+const glm::ivec3 g_lightSides[] = {
+	{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+struct LightRemoval
+{
+	glm::ivec3	pos;
+	uint8_t		light; // What the cell had before it was cleared
+};
+
+// Used as queues, both are empty again once an update returns
+static std::vector<glm::ivec3> g_lightAdds;
+static std::vector<LightRemoval> g_lightRemovals;
+
+// The chunks around the edited one, each looked up once, and the ones to remesh as bits,
+// so a flood never goes through the maps cell by cell
+struct LightCursor
+{
+	World&											world;
+	glm::ivec3										origin;
+	std::array<Chunk*, g_cursorWidth * g_cursorWidth>	chunks;
+	uint32_t										looked;
+	uint32_t										remesh;
+};
+
+// What getChunkOrigin gives, without the call, chunk sizes are powers of two
+inline glm::ivec3 getLightChunk(const glm::ivec3& pos)
+{
+	return { pos.x & -g_chunkSize.x, 0, pos.z & -g_chunkSize.z };
+}
+
+inline int32_t getCursorSlot(const LightCursor& cursor, const glm::ivec3& chunkPos)
+{
+	const int32_t x = (chunkPos.x - cursor.origin.x) / g_chunkSize.x + g_cursorReach;
+	const int32_t z = (chunkPos.z - cursor.origin.z) / g_chunkSize.z + g_cursorReach;
+	return x >= 0 && z >= 0 && x < g_cursorWidth && z < g_cursorWidth ? g_cursorWidth * z + x : -1;
+}
+
+Chunk* findCursorChunk(LightCursor& cursor, const glm::ivec3& chunkPos)
+{
+	const int32_t slot = getCursorSlot(cursor, chunkPos);
+	if (slot >= 0 && (cursor.looked >> slot) & 1)
+	{
+		return cursor.chunks[slot];
+	}
+
+	auto it = cursor.world.chunks.find(chunkPos);
+	Chunk* chunk = it != cursor.world.chunks.end() ? &it->second : nullptr;
+	if (slot >= 0)
+	{
+		cursor.chunks[slot] = chunk;
+		cursor.looked |= 1 << slot;
+	}
+	return chunk;
+}
+
+// Light doesn't go past the world height or into chunks that aren't loaded
+Block* getCell(LightCursor& cursor, const glm::ivec3& pos)
+{
+	if (pos.y < 0 || pos.y >= g_chunkSize.y)
+	{
+		return nullptr;
+	}
+
+	const glm::ivec3 chunkPos = getLightChunk(pos);
+	Chunk* chunk = findCursorChunk(cursor, chunkPos);
+	if (!chunk)
+	{
+		return nullptr;
+	}
+
+	const glm::ivec3 local = pos - chunkPos;
+	return &chunk->blocks[g_chunkSize.x * (g_chunkSize.z * local.y + local.z) + local.x];
+}
+
+void remeshLater(LightCursor& cursor, const glm::ivec3& chunkPos)
+{
+	const int32_t slot = getCursorSlot(cursor, chunkPos);
+	if (slot >= 0)
+	{
+		cursor.remesh |= 1 << slot;
+	}
+	else
+	{
+		cursor.world.chunksToRemesh.insert(chunkPos);
+	}
+}
+
+// Faces take the light of the cell in front of them, on the border those belong to the neighbour
+void setLight(LightCursor& cursor, Block& cell, const glm::ivec3& pos, uint8_t light)
+{
+	setBlockLight(cell, light);
+
+	const glm::ivec3 chunkPos = getLightChunk(pos);
+	const glm::ivec3 local = pos - chunkPos;
+	remeshLater(cursor, chunkPos);
+	if (local.x == 0) { remeshLater(cursor, chunkPos - glm::ivec3(g_chunkSize.x, 0, 0)); }
+	if (local.x == g_chunkSize.x - 1) { remeshLater(cursor, chunkPos + glm::ivec3(g_chunkSize.x, 0, 0)); }
+	if (local.z == 0) { remeshLater(cursor, chunkPos - glm::ivec3(0, 0, g_chunkSize.z)); }
+	if (local.z == g_chunkSize.z - 1) { remeshLater(cursor, chunkPos + glm::ivec3(0, 0, g_chunkSize.z)); }
+}
+
+void floodLight(LightCursor& cursor)
+{
+	for (size_t i = 0; i < g_lightAdds.size(); i++)
+	{
+		const glm::ivec3 pos = g_lightAdds[i];
+		const Block* cell = getCell(cursor, pos);
+		const uint8_t light = cell ? getBlockLight(*cell) : 0;
+		if (light <= 1)
+		{
+			continue;
+		}
+
+		for (const glm::ivec3& side : g_lightSides)
+		{
+			Block* next = getCell(cursor, pos + side);
+			if (next && !isSolidBlock(next->type) && getBlockLight(*next) + 1 < light)
+			{
+				setLight(cursor, *next, pos + side, light - 1);
+				g_lightAdds.push_back(pos + side);
+			}
+		}
+	}
+	g_lightAdds.clear();
+}
+
+void clearLight(LightCursor& cursor)
+{
+	for (size_t i = 0; i < g_lightRemovals.size(); i++)
+	{
+		const LightRemoval removal = g_lightRemovals[i];
+		for (const glm::ivec3& side : g_lightSides)
+		{
+			const glm::ivec3 pos = removal.pos + side;
+			Block* next = getCell(cursor, pos);
+			const uint8_t light = next ? getBlockLight(*next) : 0;
+			if (light == 0)
+			{
+				continue;
+			}
+
+			// Dimmer cells got their light from the removed one, the others are lit from elsewhere
+			if (light < removal.light && !getLightEmission(next->type))
+			{
+				setLight(cursor, *next, pos, 0);
+				g_lightRemovals.push_back({ pos, light });
+			}
+			else
+			{
+				g_lightAdds.push_back(pos);
+			}
+		}
+	}
+	g_lightRemovals.clear();
+}
+
+void GameModule::updateBlockLight(World& world, const glm::ivec3& pos, const Block& previous)
+{
+	g_lightAdds.reserve(g_lightQueueSize);
+	g_lightRemovals.reserve(g_lightQueueSize);
+
+	LightCursor cursor = { world, getLightChunk(pos), {}, 0, 0 };
+
+	Block* cell = getCell(cursor, pos);
+	if (!cell)
+	{
+		return;
+	}
+
+	// A solid block blocks the light that went through the cell, a removed light takes its own with it
+	const uint8_t light = getBlockLight(*cell);
+	const uint8_t emission = getLightEmission(cell->type);
+	if (light > emission && (isSolidBlock(cell->type) || getLightEmission(previous.type)))
+	{
+		setLight(cursor, *cell, pos, 0);
+		g_lightRemovals.push_back({ pos, light });
+		clearLight(cursor);
+	}
+
+	if (emission > getBlockLight(*cell))
+	{
+		setLight(cursor, *cell, pos, emission);
+		g_lightAdds.push_back(pos);
+	}
+
+	// An opened up cell takes the light of the ones around it
+	if (isSolidBlock(previous.type) && !isSolidBlock(cell->type))
+	{
+		for (const glm::ivec3& side : g_lightSides)
+		{
+			g_lightAdds.push_back(pos + side);
+		}
+	}
+
+	floodLight(cursor);
+
+	for (int32_t slot = 0; slot < g_cursorWidth * g_cursorWidth; slot++)
+	{
+		if ((cursor.remesh >> slot) & 1)
+		{
+			world.chunksToRemesh.insert(cursor.origin + glm::ivec3(
+				(slot % g_cursorWidth - g_cursorReach) * g_chunkSize.x, 0, (slot / g_cursorWidth - g_cursorReach) * g_chunkSize.z));
+		}
+	}
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "../chunk/block.h"
+
+namespace GameModule
+{
+	struct World;
+
+	// Called by setBlock once the type of a block changed, only the cells within reach
+	// of the light it took away or let through are visited and their chunks are remeshed
+	void updateBlockLight(World& world, const glm::ivec3& pos, const Block& previous);
+}
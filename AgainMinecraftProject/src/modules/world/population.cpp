@@ -0,0 +1,334 @@
+/**
+* Feature population.
+*
+* Terrain is generated per chunk, features like trees are added once all
+* eight neighbours of a chunk have their terrain, so they can reach over
+* the border. Every ready chunk places its features on a job thread and
+* only reads its own blocks, the blocks go to staging lists per target
+* chunk, each stripe of them behind its own lock. Once every chunk is done
+* the lists are applied per target chunk in parallel. A feature block only
+* takes air, and a trunk takes leaves, so the result doesn't depend on the
+* order the chunks ran in.
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+#include "../../engine/jobs/jobs.h"
+#include "../../engine/profiler/profiler.h"
+
+#include "../chunk/chunk.h"
+#include "../chunk/biome.h"
+
+#include "world.h"
+#include "population.h"
+
+using namespace GameModule;
+
+constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
+
+constexpr int32_t g_treeCell = 4; // Blocks per side of a cell that grows at most one tree
+constexpr int32_t g_minTrunk = 4;
+constexpr int32_t g_maxTrunk = 6;
+constexpr int32_t g_canopyRadius = 2;
+
+constexpr uint32_t g_stagingStripes = 16;
+
+struct StagingStripe
+{
+	std::mutex lock;
+	std::unordered_map<glm::ivec3, std::vector<BlockWrite>, World::KeyFuncs> chunks;
+};
+
+// Filled by the populating chunks, emptied when the pass applies them
+static std::array<StagingStripe, g_stagingStripes> g_staging;
+
+static std::vector<Chunk*> g_readyChunks;
+
+struct StagedChunk
+{
+	Chunk*					chunk;
+	std::vector<BlockWrite>	writes;
+};
+
+static std::vector<StagedChunk> g_stagedChunks;
+
+// Blocks of a chunk's features, sorted by the neighbour they land in
+struct FeatureWrites
+{
+	std::array<std::vector<BlockWrite>, 9>	neighbours; // 3x3 around the chunk, x first
+	uint32_t								features;
+};
+
+inline uint32_t getBlockId(const glm::ivec3& pos)
+{
+	return g_chunkSize.x * (pos.y * g_chunkSize.z + pos.z) + pos.x;
+}
+
+inline glm::ivec3 getBlockPos(uint32_t id)
+{
+	return { id % g_chunkSize.x, id / (g_chunkSize.x * g_chunkSize.z), id / g_chunkSize.x % g_chunkSize.z };
+}
+
+inline bool isFeatureBlock(BlockType type)
+{
+	return type == BlockType::LOG || type == BlockType::LEAVES;
+}
+
+// Trunks grow through the leaves of other trees, nothing else is replaced
+inline bool canReplace(BlockType current, BlockType feature)
+{
+	return current == BlockType::AIR || (current == BlockType::LEAVES && feature == BlockType::LOG);
+}
+
+// The same for a cell whichever thread asks, salted per use
+inline uint32_t hashCell(int32_t x, int32_t z, uint32_t salt)
+{
+	uint32_t hash = static_cast<uint32_t>(x) * 0x8DA6B343u ^ static_cast<uint32_t>(z) * 0xD8163841u ^ salt * 0xCB1AB31Fu;
+	hash ^= hash >> 13;
+	hash *= 0x5BD1E995u;
+	hash ^= hash >> 15;
+	return hash;
+}
+
+inline float hashToUnit(uint32_t hash)
+{
+	return static_cast<float>(hash & 0xFFFF) / 65536.0f;
+}
+
+StagingStripe& getStripe(const glm::ivec3& chunkPos)
+{
+	return g_staging[World::KeyFuncs()(chunkPos) % g_stagingStripes];
+}
+
+void addFeatureBlock(FeatureWrites& writes, const glm::ivec3& local, BlockType type)
+{
+	if (local.y < 0 || local.y >= g_chunkSize.y)
+	{
+		return;
+	}
+
+	const int32_t nx = local.x < 0 ? 0 : local.x < g_chunkSize.x ? 1 : 2;
+	const int32_t nz = local.z < 0 ? 0 : local.z < g_chunkSize.z ? 1 : 2;
+	const glm::ivec3 inNeighbour = local - glm::ivec3((nx - 1) * g_chunkSize.x, 0, (nz - 1) * g_chunkSize.z);
+	writes.neighbours[nz * 3 + nx].push_back({ getBlockId(inNeighbour), { type, 0 } });
+}
+
+// Highest block of the terrain, the features of the neighbours may already be on top of it
+int32_t findGround(const Chunk& chunk, uint32_t column)
+{
+	for (int32_t y = chunk.heights.surface[column] - 1; y >= 0; y--)
+	{
+		if (!isFeatureBlock(chunk.blocks[g_chunkColumns * y + column].type))
+		{
+			return y;
+		}
+	}
+	return -1;
+}
+
+void addTree(FeatureWrites& writes, const glm::ivec3& root, int32_t trunk)
+{
+	const int32_t top = root.y + trunk;
+
+	// Two wide layers, a narrow one around the top of the trunk and a cross above it
+	for (int32_t y = top - 2; y <= top + 1; y++)
+	{
+		const int32_t radius = y < top ? g_canopyRadius : 1;
+		for (int32_t z = -radius; z <= radius; z++)
+		{
+			for (int32_t x = -radius; x <= radius; x++)
+			{
+				const bool corner = std::abs(x) == radius && std::abs(z) == radius;
+				if (corner && y != top)
+				{
+					continue;
+				}
+				addFeatureBlock(writes, glm::ivec3(root.x + x, y, root.z + z), BlockType::LEAVES);
+			}
+		}
+	}
+
+	for (int32_t y = root.y; y < top; y++)
+	{
+		addFeatureBlock(writes, glm::ivec3(root.x, y, root.z), BlockType::LOG);
+	}
+	writes.features++;
+}
+
+// One tree at most per cell, kept off the cell border so two trunks never touch
+void placeTrees(const Chunk& chunk, const ChunkBiomes& biomes, FeatureWrites& writes)
+{
+	const glm::ivec3 pos = glm::ivec3(chunk.pos);
+	for (int32_t cz = 0; cz < g_chunkSize.z; cz += g_treeCell)
+	{
+		for (int32_t cx = 0; cx < g_chunkSize.x; cx += g_treeCell)
+		{
+			const uint32_t hash = hashCell(pos.x + cx, pos.z + cz, 1);
+			const int32_t x = cx + 1 + (hash >> 16 & 1);
+			const int32_t z = cz + 1 + (hash >> 17 & 1);
+			const uint32_t column = g_chunkSize.x * z + x;
+
+			if (hashToUnit(hash) >= getTreeDensity(biomes[column].type))
+			{
+				continue;
+			}
+
+			const int32_t ground = findGround(chunk, column);
+			const int32_t trunk = g_minTrunk + static_cast<int32_t>(hash >> 18) % (g_maxTrunk - g_minTrunk + 1);
+			if (ground < 0 || ground + trunk + 2 >= g_chunkSize.y)
+			{
+				continue;
+			}
+
+			const BlockType soil = chunk.blocks[g_chunkColumns * ground + column].type;
+			if (soil == BlockType::GRASS || soil == BlockType::SNOW)
+			{
+				addTree(writes, glm::ivec3(x, ground + 1, z), trunk);
+			}
+		}
+	}
+}
+
+// Only reads the chunk itself, the neighbours may be written at the same time
+void populateChunk(const Chunk& chunk, std::atomic<uint32_t>& features, std::atomic<uint32_t>& crossing)
+{
+	thread_local FeatureWrites t_writes;
+	for (std::vector<BlockWrite>& writes : t_writes.neighbours)
+	{
+		writes.clear();
+	}
+	t_writes.features = 0;
+
+	ChunkBiomes biomes;
+	getChunkBiomes(glm::ivec3(chunk.pos), biomes);
+	placeTrees(chunk, biomes, t_writes);
+
+	for (int32_t i = 0; i < 9; i++)
+	{
+		if (t_writes.neighbours[i].empty())
+		{
+			continue;
+		}
+
+		const glm::ivec3 target = glm::ivec3(chunk.pos) + glm::ivec3((i % 3 - 1) * g_chunkSize.x, 0, (i / 3 - 1) * g_chunkSize.z);
+		if (target != glm::ivec3(chunk.pos))
+		{
+			crossing += static_cast<uint32_t>(t_writes.neighbours[i].size());
+		}
+
+		StagingStripe& stripe = getStripe(target);
+
+		std::lock_guard<std::mutex> lock(stripe.lock);
+		std::vector<BlockWrite>& staged = stripe.chunks[target];
+		staged.insert(staged.end(), t_writes.neighbours[i].begin(), t_writes.neighbours[i].end());
+	}
+	features += t_writes.features;
+}
+
+void applyStagedChunk(StagedChunk& staged)
+{
+	Chunk& chunk = *staged.chunk;
+	for (const BlockWrite& write : staged.writes)
+	{
+		Block& block = chunk.blocks[write.id];
+		if (canReplace(block.type, write.block.type))
+		{
+			block.type = write.block.type;
+			updateColumnHeights(chunk, getBlockPos(write.id));
+		}
+	}
+}
+
+bool isNeighbourhoodLoaded(const World& world, const glm::ivec3& pos)
+{
+	for (int32_t z = -1; z <= 1; z++)
+	{
+		for (int32_t x = -1; x <= 1; x++)
+		{
+			if (!world.chunks.count(pos + glm::ivec3(x * g_chunkSize.x, 0, z * g_chunkSize.z)))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+PopulatePass GameModule::populateChunks(World& world)
+{
+	PopulatePass pass = {};
+
+	g_readyChunks.clear();
+	for (auto& it : world.chunks)
+	{
+		if (!it.second.populated && isNeighbourhoodLoaded(world, it.first))
+		{
+			g_readyChunks.push_back(&it.second);
+		}
+	}
+
+	if (g_readyChunks.empty())
+	{
+		return pass;
+	}
+
+	PROFILE_SCOPE("populateChunks");
+
+	pass.chunks = static_cast<uint32_t>(g_readyChunks.size());
+
+	std::atomic<uint32_t> features(0);
+	std::atomic<uint32_t> crossing(0);
+	Engine::parallelFor("populateChunk", pass.chunks, 1, [&features, &crossing](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			populateChunk(*g_readyChunks[i], features, crossing);
+		}
+	});
+	pass.features = features;
+	pass.crossing = crossing;
+
+	// Every target is loaded, the neighbourhood of each ready chunk is
+	g_stagedChunks.clear();
+	for (StagingStripe& stripe : g_staging)
+	{
+		for (auto& staged : stripe.chunks)
+		{
+			g_stagedChunks.push_back({ &world.chunks[staged.first], std::move(staged.second) });
+		}
+		stripe.chunks.clear();
+	}
+
+	// Each target only writes its own blocks
+	Engine::parallelFor("applyFeatures", static_cast<uint32_t>(g_stagedChunks.size()), 1, [](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			applyStagedChunk(g_stagedChunks[i]);
+		}
+	});
+
+	for (StagedChunk& staged : g_stagedChunks)
+	{
+		pass.writes += static_cast<uint32_t>(staged.writes.size());
+
+		// Leaves on the border have faces in the neighbour, whole neighbourhoods get remeshed anyway
+		if (staged.chunk->solidBuffer)
+		{
+			const glm::ivec3 pos = glm::ivec3(staged.chunk->pos);
+			world.chunksToRemesh.insert(pos);
+			world.chunksToRemesh.insert(staged.chunk->left);
+			world.chunksToRemesh.insert(staged.chunk->right);
+			world.chunksToRemesh.insert(staged.chunk->front);
+			world.chunksToRemesh.insert(staged.chunk->back);
+			world.solidityChanged.insert(pos);
+		}
+	}
+
+	for (Chunk* chunk : g_readyChunks)
+	{
+		chunk->populated = true;
+	}
+
+	return pass;
+}
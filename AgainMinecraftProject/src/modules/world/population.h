@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "../chunk/block.h"
+
+namespace GameModule
+{
+	struct World;
+
+	struct PopulatePass
+	{
+		uint32_t chunks;	// Populated by the pass
+		uint32_t features;
+		uint32_t writes;	// Blocks staged by the features, in their chunk and in the neighbours
+		uint32_t crossing;	// Of the writes, the ones staged for a neighbour
+	};
+
+	// Populates every chunk whose 3x3 neighbourhood has terrain, features can reach into the
+	// neighbours. Chunks that already have buffers get remeshed, fresh ones are meshed later.
+	PopulatePass populateChunks(World& world);
+}
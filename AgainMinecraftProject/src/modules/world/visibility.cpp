@@ -0,0 +1,385 @@
+/**
+* Visibility graph.
+*
+* Meshing a chunk flood fills the open cells of each of its sections and
+* keeps, per side, which other sides an opening from it leads to. Every
+* frame a breadth first search starts in the section of the camera and only
+* goes from a section into a neighbour through a side the entered one links
+* to, and never back against a direction it already went, so sections behind
+* solid ground or off in a sealed cave are never reached. Chunks are drawn
+* when any of their sections is reached. Shadows can fall into view from
+* chunks out of sight, so the chunks towards the light of the reached ones
+* stay casters as far as the highest block can throw a shadow.
+*/
+
+#include <algorithm>
+
+#include "../../engine/profiler/profiler.h"
+
+#include "../chunk/chunk.h"
+
+#include "world.h"
+#include "visibility.h"
+
+using namespace GameModule;
+
+constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
+
+constexpr int32_t g_sectionSize = 16;
+constexpr uint32_t g_sectionCells = g_sectionSize * g_sectionSize * g_sectionSize;
+constexpr int32_t g_noNode = -1;
+
+// Chunk neighbours in the order of the horizontal section faces
+const glm::ivec2 g_nodeSides[] = { { 1, 0 }, { -1, 0 }, { 0, 0 }, { 0, 0 }, { 0, 1 }, { 0, -1 } };
+
+struct VisibilityNode
+{
+	Chunk*	chunk;
+	int32_t	neighbours[6]; // Only the horizontal faces are set
+	uint16_t visited;
+};
+
+struct SectionStep
+{
+	int32_t	node;
+	uint8_t	section;
+	uint8_t	entry;		// Face it was entered through, none for the camera section
+	uint8_t	directions;	// Faces the search went out of to get here
+};
+
+// Rebuilt every frame, a grid of the loaded chunks so no step looks up the map
+static std::vector<VisibilityNode> g_nodes;
+static std::vector<int32_t> g_nodeGrid;
+static std::vector<SectionStep> g_sectionQueue;
+
+struct NodeGrid
+{
+	glm::ivec2	min;
+	glm::ivec2	size;
+};
+
+inline uint8_t getCellFaces(int32_t x, int32_t y, int32_t z)
+{
+	return
+		(x == g_sectionSize - 1) << static_cast<uint8_t>(SectionFace::RIGHT) |
+		(x == 0) << static_cast<uint8_t>(SectionFace::LEFT) |
+		(y == g_sectionSize - 1) << static_cast<uint8_t>(SectionFace::TOP) |
+		(y == 0) << static_cast<uint8_t>(SectionFace::BOTTOM) |
+		(z == g_sectionSize - 1) << static_cast<uint8_t>(SectionFace::FRONT) |
+		(z == 0) << static_cast<uint8_t>(SectionFace::BACK);
+}
+
+using CellSet = std::array<uint64_t, g_sectionCells / 64>;
+
+// Sides of the section the opening around the start cell touches
+uint8_t floodSection(const Block* blocks, uint32_t start, CellSet& visited)
+{
+	thread_local std::array<uint16_t, g_sectionCells> t_stack;
+
+	uint8_t faces = 0;
+	uint32_t size = 0;
+	t_stack[size++] = static_cast<uint16_t>(start);
+	visited[start >> 6] |= uint64_t(1) << (start & 63);
+
+	while (size > 0)
+	{
+		const uint32_t cell = t_stack[--size];
+		const int32_t x = cell % g_sectionSize;
+		const int32_t z = cell / g_sectionSize % g_sectionSize;
+		const int32_t y = cell / (g_sectionSize * g_sectionSize);
+		faces |= getCellFaces(x, y, z);
+
+		const int32_t neighbours[] = {
+			x + 1 < g_sectionSize ? static_cast<int32_t>(cell) + 1 : -1,
+			x > 0 ? static_cast<int32_t>(cell) - 1 : -1,
+			y + 1 < g_sectionSize ? static_cast<int32_t>(cell) + g_sectionSize * g_sectionSize : -1,
+			y > 0 ? static_cast<int32_t>(cell) - g_sectionSize * g_sectionSize : -1,
+			z + 1 < g_sectionSize ? static_cast<int32_t>(cell) + g_sectionSize : -1,
+			z > 0 ? static_cast<int32_t>(cell) - g_sectionSize : -1 };
+
+		for (int32_t next : neighbours)
+		{
+			if (next < 0 || isSolidBlock(blocks[next].type) || visited[next >> 6] >> (next & 63) & 1)
+			{
+				continue;
+			}
+			visited[next >> 6] |= uint64_t(1) << (next & 63);
+			t_stack[size++] = static_cast<uint16_t>(next);
+		}
+	}
+	return faces;
+}
+
+// The sides every separate opening of the section touches are linked to each other
+void linkSection(const Chunk& chunk, uint32_t section, std::array<uint8_t, 6>& links)
+{
+	const Block* blocks = chunk.blocks.data() + section * g_sectionCells;
+
+	uint32_t open = 0;
+	for (uint32_t cell = 0; cell < g_sectionCells; cell++)
+	{
+		open += !isSolidBlock(blocks[cell].type);
+	}
+
+	links.fill(open == g_sectionCells ? g_allSectionFaces : 0);
+	if (open == 0 || open == g_sectionCells)
+	{
+		return;
+	}
+
+	CellSet visited = {};
+	for (uint32_t start = 0; start < g_sectionCells; start++)
+	{
+		if (isSolidBlock(blocks[start].type) || visited[start >> 6] >> (start & 63) & 1)
+		{
+			continue;
+		}
+
+		const uint8_t faces = floodSection(blocks, start, visited);
+		for (uint8_t face = 0; face < 6; face++)
+		{
+			if (faces >> face & 1)
+			{
+				links[face] |= faces;
+			}
+		}
+	}
+}
+
+void GameModule::linkChunkSections(Chunk& chunk)
+{
+	for (uint32_t section = 0; section < g_chunkSections; section++)
+	{
+		linkSection(chunk, section, chunk.links[section]);
+	}
+	chunk.skyFloor = *std::min_element(chunk.heights.opaque.begin(), chunk.heights.opaque.end());
+}
+
+inline int32_t findNode(const NodeGrid& grid, int32_t x, int32_t z)
+{
+	x -= grid.min.x;
+	z -= grid.min.y;
+	if (x < 0 || z < 0 || x >= grid.size.x || z >= grid.size.y)
+	{
+		return g_noNode;
+	}
+	return g_nodeGrid[grid.size.x * z + x];
+}
+
+NodeGrid buildNodes(World& world)
+{
+	g_nodes.clear();
+
+	NodeGrid grid = { glm::ivec2(std::numeric_limits<int32_t>::max()), glm::ivec2(0) };
+	glm::ivec2 max = glm::ivec2(std::numeric_limits<int32_t>::min());
+	for (auto& pair : world.chunks)
+	{
+		const glm::ivec2 cell = glm::ivec2(pair.first.x, pair.first.z) / g_sectionSize;
+		grid.min = glm::min(grid.min, cell);
+		max = glm::max(max, cell);
+		g_nodes.push_back({ &pair.second, {}, 0 });
+	}
+	if (g_nodes.empty())
+	{
+		return grid;
+	}
+
+	grid.size = max - grid.min + 1;
+	g_nodeGrid.assign(grid.size.x * grid.size.y, g_noNode);
+	for (int32_t i = 0; i < static_cast<int32_t>(g_nodes.size()); i++)
+	{
+		const glm::ivec2 cell = glm::ivec2(g_nodes[i].chunk->pos.x, g_nodes[i].chunk->pos.z) / g_sectionSize - grid.min;
+		g_nodeGrid[grid.size.x * cell.y + cell.x] = i;
+	}
+
+	for (VisibilityNode& node : g_nodes)
+	{
+		const glm::ivec2 cell = glm::ivec2(node.chunk->pos.x, node.chunk->pos.z) / g_sectionSize;
+		for (uint8_t face = 0; face < 6; face++)
+		{
+			node.neighbours[face] = findNode(grid, cell.x + g_nodeSides[face].x, cell.y + g_nodeSides[face].y);
+		}
+	}
+	return grid;
+}
+
+// The camera only sees out of the sides its own opening touches, out of every one from inside a block
+uint8_t getCameraExits(const Chunk& chunk, const glm::ivec3& cell)
+{
+	const uint32_t section = cell.y / g_sectionSize;
+	const uint32_t local = g_sectionSize * (g_sectionSize * (cell.y % g_sectionSize) + cell.z) + cell.x;
+	const Block* blocks = chunk.blocks.data() + section * g_sectionCells;
+	if (isSolidBlock(blocks[local].type))
+	{
+		return g_allSectionFaces;
+	}
+
+	CellSet visited = {};
+	return floodSection(blocks, local, visited);
+}
+
+void searchSections(int32_t startNode, uint8_t startSection, uint8_t startExits)
+{
+	g_sectionQueue.clear();
+	g_sectionQueue.push_back({ startNode, startSection, 0xFF, 0 });
+	g_nodes[startNode].visited = 1 << startSection;
+
+	for (size_t i = 0; i < g_sectionQueue.size(); i++)
+	{
+		const SectionStep step = g_sectionQueue[i];
+		const VisibilityNode& node = g_nodes[step.node];
+
+		const uint8_t exits = step.entry == 0xFF ? startExits : node.chunk->links[step.section][step.entry];
+		for (uint8_t face = 0; face < 6; face++)
+		{
+			if (!(exits >> face & 1) || step.directions >> getOppositeFace(face) & 1)
+			{
+				continue;
+			}
+
+			int32_t next = step.node;
+			int32_t section = step.section;
+			if (face == static_cast<uint8_t>(SectionFace::TOP))
+			{
+				section++;
+			}
+			else if (face == static_cast<uint8_t>(SectionFace::BOTTOM))
+			{
+				section--;
+			}
+			else
+			{
+				next = node.neighbours[face];
+			}
+
+			if (next == g_noNode || section < 0 || section >= static_cast<int32_t>(g_chunkSections) ||
+				g_nodes[next].visited >> section & 1)
+			{
+				continue;
+			}
+
+			g_nodes[next].visited |= 1 << section;
+			g_sectionQueue.push_back({ next, static_cast<uint8_t>(section), getOppositeFace(face),
+				static_cast<uint8_t>(step.directions | 1 << face) });
+		}
+	}
+}
+
+// A block lit from the side of the light throws its shadow away from it, as far as
+// its height over the receiver allows, the chunks in between keep their casters
+void markShadowCasters(World& world, const NodeGrid& grid)
+{
+	const glm::vec2 toLight = glm::vec2(world.lightDir.x, world.lightDir.z);
+	const float horizontal = glm::length(toLight);
+
+	int32_t top = 0;
+	for (const VisibilityNode& node : g_nodes)
+	{
+		top = std::max(top, node.chunk->maxSolidY);
+	}
+
+	// A light at the horizon casts across the whole world
+	const bool everyCaster = world.lightDir.y <= 0.0f;
+	const float slope = everyCaster ? 0.0f : horizontal / world.lightDir.y;
+	const glm::vec2 dir = horizontal > 0.0f ? toLight / horizontal : glm::vec2(0.0f);
+
+	for (VisibilityNode& node : g_nodes)
+	{
+		Chunk& chunk = *node.chunk;
+		chunk.visibleSections = node.visited;
+		chunk.shadowVisible = everyCaster;
+	}
+	if (everyCaster)
+	{
+		return;
+	}
+
+	// Walked along the axis the light is closer to, in chunks
+	const bool alongX = std::abs(dir.x) >= std::abs(dir.y);
+	const float major = alongX ? dir.x : dir.y;
+	const int32_t step = major < 0.0f ? -1 : 1;
+	const float ratio = major != 0.0f ? (alongX ? dir.y : dir.x) / std::abs(major) : 0.0f;
+
+	// Looking over the surface every chunk soon turns out to be a caster
+	uint32_t casters = 0;
+	for (const VisibilityNode& node : g_nodes)
+	{
+		if (!node.visited)
+		{
+			continue;
+		}
+		if (casters == g_nodes.size())
+		{
+			break;
+		}
+
+		// Cells under the lowest opaque column don't see the sun, the baked skylight darkens them
+		const Chunk& chunk = *node.chunk;
+		const int32_t lowestSection = g_sectionSize * static_cast<int32_t>(glm::findLSB(static_cast<uint32_t>(node.visited)));
+		const int32_t receiver = std::max<int32_t>(lowestSection, chunk.skyFloor);
+		const float reach = std::max(0, top - receiver) * slope * std::abs(major) / g_sectionSize;
+
+		// The chunk swept towards the light, a column is touched by the centres within a chunk of it
+		const glm::ivec2 origin = glm::ivec2(chunk.pos.x, chunk.pos.z) / g_sectionSize;
+		for (int32_t i = 0; i <= static_cast<int32_t>(std::ceil(reach)); i++)
+		{
+			const float from = std::max(i - 1.0f, 0.0f) * ratio;
+			const float to = std::min(i + 1.0f, reach) * ratio;
+			const int32_t first = static_cast<int32_t>(std::floor(std::min(from, to) - 1.0f)) + 1;
+			const int32_t last = static_cast<int32_t>(std::ceil(std::max(from, to) + 1.0f)) - 1;
+
+			for (int32_t j = first; j <= last; j++)
+			{
+				const int32_t caster = alongX ?
+					findNode(grid, origin.x + i * step, origin.y + j) :
+					findNode(grid, origin.x + j, origin.y + i * step);
+				if (caster != g_noNode && !g_nodes[caster].chunk->shadowVisible)
+				{
+					g_nodes[caster].chunk->shadowVisible = true;
+					casters++;
+				}
+			}
+		}
+	}
+}
+
+VisibilityStats GameModule::updateVisibility(World& world, const glm::vec3& cameraPos)
+{
+	PROFILE_SCOPE("updateVisibility");
+
+	VisibilityStats stats = {};
+
+	const NodeGrid grid = buildNodes(world);
+	const glm::ivec2 cameraCell = glm::floor(glm::vec2(cameraPos.x, cameraPos.z) / static_cast<float>(g_sectionSize));
+	const int32_t start = g_nodes.empty() ? g_noNode : findNode(grid, cameraCell.x, cameraCell.y);
+
+	if (!world.cullOccluded || start == g_noNode)
+	{
+		for (VisibilityNode& node : g_nodes)
+		{
+			node.chunk->visibleSections = 0xFFFF;
+			node.chunk->shadowVisible = true;
+		}
+		stats.sections = static_cast<uint32_t>(g_nodes.size()) * g_chunkSections;
+		stats.chunks = static_cast<uint32_t>(g_nodes.size());
+		stats.casters = stats.chunks;
+		return stats;
+	}
+
+	// Above or below the world the camera looks in through every side of the closest section
+	const Chunk& chunk = *g_nodes[start].chunk;
+	const int32_t y = static_cast<int32_t>(std::floor(cameraPos.y));
+	const int32_t section = glm::clamp(y / g_sectionSize, 0, static_cast<int32_t>(g_chunkSections) - 1);
+	const uint8_t exits = y < 0 || y >= g_chunkSize.y ? g_allSectionFaces : getCameraExits(chunk,
+		glm::ivec3(glm::floor(cameraPos)) - glm::ivec3(chunk.pos.x, 0, chunk.pos.z));
+	searchSections(start, static_cast<uint8_t>(section), exits);
+	markShadowCasters(world, grid);
+
+	stats.sections = static_cast<uint32_t>(g_sectionQueue.size());
+	for (const VisibilityNode& node : g_nodes)
+	{
+		stats.chunks += node.visited != 0;
+		stats.casters += node.chunk->shadowVisible;
+	}
+	return stats;
+}
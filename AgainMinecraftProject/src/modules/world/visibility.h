@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace GameModule
+{
+	struct World;
+	struct Chunk;
+
+	// Sides of a 16x16x16 section in the order of the links, the opposite side is the next or previous one
+	enum class SectionFace : uint8_t
+	{
+		RIGHT,	// +x
+		LEFT,
+		TOP,	// +y
+		BOTTOM,
+		FRONT,	// +z
+		BACK
+	};
+
+	constexpr uint8_t g_allSectionFaces = 0x3F;
+
+	struct VisibilityStats
+	{
+		uint32_t sections;	// Reached by the search
+		uint32_t chunks;	// With at least one of them
+		uint32_t casters;	// Whose shadow may fall on them
+	};
+
+	inline uint8_t getOppositeFace(uint8_t face)
+	{
+		return face ^ 1;
+	}
+
+	// Flood fills the open cells of every section, part of meshing the chunk
+	void linkChunkSections(Chunk& chunk);
+
+	// Searches the sections the camera can see into and marks their chunks and the chunks that
+	// can shadow them, everything stays visible without the camera chunk or with culling off
+	VisibilityStats updateVisibility(World& world, const glm::vec3& cameraPos);
+}
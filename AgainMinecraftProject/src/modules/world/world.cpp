@@ -17,12 +17,20 @@
 #include "../../engine/shader/shader.h"
 #include "../../engine/renderer/block_renderer.h"
 #include "../../engine/renderer/mesh.h"
+#include "../../engine/renderer/commands.h"
+#include "../../engine/renderer/staging.h"
 #include "../../engine/window/window.h"
+#include "../../engine/profiler/profiler.h"
+#include "../../engine/jobs/jobs.h"
 
 #include "../chunk/chunk.h"
 #include "../player/player.h"
 
 #include "world.h"
+#include "light.h"
+#include "cascade.h"
+#include "population.h"
+#include "visibility.h"
 
 using namespace GameModule;
 
@@ -30,6 +38,13 @@ constexpr glm::ivec3 g_chunkSize = { 16, 256, 16 };
 constexpr size_t g_nBlocks = g_chunkSize.x * g_chunkSize.y * g_chunkSize.z;
 constexpr size_t g_updateDistance = g_chunkSize.x * (g_chunksX / 2 - 1);
 
+constexpr float g_waterSortDistance = 2.0f * g_chunkSize.x;
+
+constexpr size_t g_frameArenaSize = 64 * 1024;
+
+constexpr size_t g_stagingSize = 8 * 1024 * 1024;
+constexpr size_t g_frameUploadBudget = 2 * 1024 * 1024;
+
 constexpr size_t g_width = 1280;
 constexpr size_t g_height = 720;
 
@@ -38,13 +53,14 @@ std::vector<std::future<void>> g_futures;
 
 void initParallelChunks(World& world, const glm::vec3& min, const glm::vec3& max)
 {
+	PROFILE_SCOPE("initParallelChunks");
+
 	for (int32_t z = min.z; z < max.z; z += g_chunkSize.z)
 	{
 		for (int32_t x = min.x; x < max.x; x += g_chunkSize.x)
 		{
 			glm::ivec3 chunkPos = { x, 0, z };
-			Chunk chunk = generateChunk(chunkPos);
-			initChunkFaces(chunk);
+			Chunk chunk = generateChunk(chunkPos, world.terrain);
 			chunk.updated = false;
 
 			std::lock_guard<std::mutex> lock(g_worldMutex);
@@ -63,12 +79,26 @@ void initCascadeShadows(World& world, const Player& player)
 
 void GameModule::initWorld(World& world, const Player& player)
 {
+	PROFILE_SCOPE("initWorld");
+
 	initCascadeShadows(world, player);
 	Engine::initFArrayBuffer(world.shadowBuffer, world.shadowCascadeLevels);
 	Engine::Renderer::initUBufferLM(world.lightSpaceMatricesUBO);
+	Engine::Renderer::initUBufferFD(world.frameDataUBO);
+
+	Engine::Renderer::initUploadManager(world.uploads, g_stagingSize);
+	world.commands.uploads = &world.uploads;
 
+	initWorldChunks(world);
+}
+
+void GameModule::initWorldChunks(World& world)
+{
 	world.pos = glm::ivec3(0);
 	world.fractionPos = glm::vec3(0.0f);
+	world.transparentOrder.reserve(g_chunksX * g_chunksZ);
+	Engine::Renderer::initBufferPool(world.pool, 3 * g_chunksX * g_chunksZ);
+	Engine::initFrameArena(world.frameArena, g_frameArenaSize);
 
 	uint32_t maxThreads = std::thread::hardware_concurrency();
 	uint32_t availableThreads = maxThreads - 1;
@@ -97,13 +127,34 @@ void GameModule::initWorld(World& world, const Player& player)
 			{
 				threads.push_back(
 					std::move(
-						std::thread(initParallelChunks,
-							std::ref(world), glm::vec3(minX, 0, minZ), glm::vec3(minX + step, 0, minZ + step))));
+						std::thread([&world, minX, minZ, step]()
+							{
+								Engine::setTraceThreadName("chunkWorker");
+								initParallelChunks(world, glm::vec3(minX, 0, minZ), glm::vec3(minX + step, 0, minZ + step));
+							})));
 			}
 		}
 	}
 	for_each(threads.begin(), threads.end(), std::mem_fn(&std::thread::join));
 
+	// Features reach into the neighbours, so the faces wait until every chunk that can is populated
+	populateChunks(world);
+
+	std::vector<Chunk*> chunks;
+	chunks.reserve(world.chunks.size());
+	for (auto& it : world.chunks)
+	{
+		chunks.push_back(&it.second);
+	}
+	Engine::parallelFor("initChunkFaces", static_cast<uint32_t>(chunks.size()), 1, [&chunks](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			initChunkFaces(*chunks[i]);
+		}
+	});
+
+	PROFILE_SCOPE("stitchAndUpload");
+
 	for (int32_t z = 0; z < g_chunkSize.z * g_chunksZ; z += g_chunkSize.z)
 	{
 		for (int32_t x = 0; x < g_chunkSize.x * g_chunksX; x += g_chunkSize.x)
@@ -124,39 +175,54 @@ void GameModule::initWorld(World& world, const Player& player)
 		}
 	}
 
+	Engine::Renderer::beginCommands(world.commands);
 	for (int32_t z = 0; z < g_chunksZ; z++)
 	{
 		for (int32_t x = 0; x < g_chunksX; x++)
 		{
-			glm::ivec3 chunkPos = { x * g_chunkSize.x, 0, z * g_chunkSize.z };
-
+			Chunk& chunk = world.chunks[{ x * g_chunkSize.x, 0, z * g_chunkSize.z }];
 
-			for (auto& buffer : world.pool.buffers)
+			if (acquireChunkBuffers(chunk, world.pool))
 			{
-				if (!buffer.active)
-				{
-					if (!world.chunks[chunkPos].solidBuffer)
-					{
-						world.chunks[chunkPos].solidBuffer = &buffer;
-						buffer.active = true;
-						world.pool.activeCounter++;
-					}
-					else if (!world.chunks[chunkPos].transBuffer)
-					{
-						world.chunks[chunkPos].transBuffer = &buffer;
-						buffer.active = true;
-						world.pool.activeCounter++;
-					}
-					else
-					{
-						break;
-					}
-					loadChunkMesh(world.chunks[chunkPos]);
-					world.chunks[chunkPos].updated = true;
-				}
+				loadChunkMesh(chunk, world.commands);
+				chunk.updated = true;
+				world.transparentOrderDirty = true;
 			}
+			world.loaded.insert(glm::ivec3(chunk.pos));
+			buildSolidMask(world.solidity[glm::ivec3(chunk.pos)], chunk);
 		}
 	}
+	Engine::Renderer::submitCommands(world.commands);
+}
+
+WorldMemory GameModule::getWorldMemory(World& world)
+{
+	WorldMemory memory = {};
+
+	std::lock_guard<std::mutex> lock(g_worldMutex);
+
+	for (const auto& pair : world.chunks)
+	{
+		const Chunk& chunk = pair.second;
+		memory.chunks++;
+		memory.blockBytes += chunk.blocks.capacity() * sizeof(Block);
+
+		for (const Engine::Renderer::Mesh* mesh : { &chunk.solidMesh, &chunk.transparentMesh, &chunk.casterMesh })
+		{
+			memory.meshBytes += mesh->size() * sizeof(Engine::Renderer::Vertex);
+			memory.meshSlackBytes += (mesh->capacity() - mesh->size()) * sizeof(Engine::Renderer::Vertex);
+		}
+	}
+
+	for (const auto& buffer : world.pool.buffers)
+	{
+		memory.gpuMeshBytes += buffer.bytes;
+	}
+	memory.gpuBytes = Engine::Renderer::getGpuBufferBytes();
+	memory.activeBuffers = world.pool.activeCounter;
+	memory.poolSize = world.pool.buffers.size();
+
+	return memory;
 }
 
 inline glm::ivec3 getChunkPos(const glm::vec3 pos)
@@ -221,6 +287,10 @@ bool isBlockTrans(World& world, const glm::vec3 pos)
 
 void GameModule::initChunkFaces(Chunk& chunk)
 {
+	TRACE_SCOPE("meshChunk");
+
+	linkChunkSections(chunk);
+
 	for (uint32_t y = 0; y < g_chunkSize.y; y++)
 	{
 		for (uint32_t z = 0; z < g_chunkSize.z; z++)
@@ -244,19 +314,19 @@ void GameModule::initChunkFaces(Chunk& chunk)
 					if (top.y < g_chunkSize.y &&
 						chunk.blocks[topId].type != BlockType::AIR)
 					{
-						setBlockFace(chunk, top, chunk.blocks[topId].type, Face::FaceType::BOTTOM);
+						setBlockFace(chunk, top, chunk.blocks[topId].type, Face::FaceType::BOTTOM, getCellLight(chunk, iBlock));
 					}
 
 					if (front.z < g_chunkSize.z &&
 						chunk.blocks[frontId].type != BlockType::AIR)
 					{
-						setBlockFace(chunk, front, chunk.blocks[frontId].type, Face::FaceType::BACK);
+						setBlockFace(chunk, front, chunk.blocks[frontId].type, Face::FaceType::BACK, getCellLight(chunk, iBlock));
 					}
 
 					if (right.x < g_chunkSize.x &&
 						chunk.blocks[rightId].type != BlockType::AIR)
 					{
-						setBlockFace(chunk, right, chunk.blocks[rightId].type, Face::FaceType::LEFT);
+						setBlockFace(chunk, right, chunk.blocks[rightId].type, Face::FaceType::LEFT, getCellLight(chunk, iBlock));
 					}
 				}
 				else if (chunk.blocks[iBlock].type == BlockType::WATER)
@@ -265,39 +335,39 @@ void GameModule::initChunkFaces(Chunk& chunk)
 						(chunk.blocks[topId].type != BlockType::AIR &&
 							chunk.blocks[topId].type != BlockType::WATER))
 					{
-						setBlockFace(chunk, top, chunk.blocks[topId].type, Face::FaceType::BOTTOM);
+						setBlockFace(chunk, top, chunk.blocks[topId].type, Face::FaceType::BOTTOM, getCellLight(chunk, iBlock));
 					}
 
 					if (front.z < g_chunkSize.z &&
 						(chunk.blocks[frontId].type != BlockType::AIR &&
 							chunk.blocks[frontId].type != BlockType::WATER))
 					{
-						setBlockFace(chunk, front, chunk.blocks[frontId].type, Face::FaceType::BACK);
+						setBlockFace(chunk, front, chunk.blocks[frontId].type, Face::FaceType::BACK, getCellLight(chunk, iBlock));
 					}
 
 					if (right.x < g_chunkSize.x &&
 						(chunk.blocks[rightId].type != BlockType::AIR &&
 							chunk.blocks[rightId].type != BlockType::WATER))
 					{
-						setBlockFace(chunk, right, chunk.blocks[rightId].type, Face::FaceType::LEFT);
+						setBlockFace(chunk, right, chunk.blocks[rightId].type, Face::FaceType::LEFT, getCellLight(chunk, iBlock));
 					}
 
 					if (top.y < g_chunkSize.y &&
 						chunk.blocks[topId].type == BlockType::AIR)
 					{
-						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::TOP);
+						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::TOP, getCellLight(chunk, topId));
 					}
 
 					if (front.z < g_chunkSize.z &&
 						chunk.blocks[frontId].type == BlockType::AIR)
 					{
-						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::FRONT);
+						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::FRONT, getCellLight(chunk, frontId));
 					}
 
 					if (right.x < g_chunkSize.x &&
 						chunk.blocks[rightId].type == BlockType::AIR)
 					{
-						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::RIGHT);
+						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::RIGHT, getCellLight(chunk, rightId));
 					}
 				}
 				else
@@ -306,21 +376,21 @@ void GameModule::initChunkFaces(Chunk& chunk)
 						(chunk.blocks[topId].type == BlockType::AIR ||
 							chunk.blocks[topId].type == BlockType::WATER))
 					{
-						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::TOP);
+						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::TOP, getCellLight(chunk, topId));
 					}
 
 					if (front.z < g_chunkSize.z &&
 						(chunk.blocks[frontId].type == BlockType::AIR ||
 							chunk.blocks[frontId].type == BlockType::WATER))
 					{
-						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::FRONT);
+						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::FRONT, getCellLight(chunk, frontId));
 					}
 
 					if (right.x < g_chunkSize.x &&
 						(chunk.blocks[rightId].type == BlockType::AIR ||
 							chunk.blocks[rightId].type == BlockType::WATER))
 					{
-						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::RIGHT);
+						setBlockFace(chunk, pos, chunk.blocks[iBlock].type, Face::FaceType::RIGHT, getCellLight(chunk, rightId));
 					}
 				}
 			}
@@ -335,74 +405,276 @@ bool isChunkInTerrain(const World& world, const glm::ivec3& pos)
 		pos.z >= world.pos.z && pos.z < world.pos.z + g_chunkSize.z * g_chunksZ;
 }
 
-void addChunks(World& world)
+// Rebuilds the CPU meshes of a chunk whose meshes were released after the upload
+void remeshChunk(World& world, Chunk& chunk)
 {
-	//while (!world.chunksToAdd.empty())
+	chunk.solidMesh.clear();
+	chunk.transparentMesh.clear();
+	chunk.minSolidY = std::numeric_limits<int32_t>::max();
+	chunk.maxSolidY = std::numeric_limits<int32_t>::min();
+
+	initChunkFaces(chunk);
+	for (const glm::ivec3& pos : { chunk.front, chunk.back, chunk.right, chunk.left })
 	{
-		Chunk chunk = generateChunk(*world.chunksToAdd.begin());
-		initChunkFaces(chunk);
+		auto it = world.chunks.find(pos);
+		if (it != world.chunks.end())
+		{
+			stitchChunkFaces(chunk, it->second);
+		}
+	}
+
+	chunk.meshReleased = false;
+	chunk.updated = false;
+}
+
+glm::ivec3 GameModule::getChunkOrigin(const glm::ivec3& pos)
+{
+	// Rounded down, also for negative coordinates
+	return {
+		(pos.x >= 0 ? pos.x : pos.x - g_chunkSize.x + 1) / g_chunkSize.x * g_chunkSize.x,
+		0,
+		(pos.z >= 0 ? pos.z : pos.z - g_chunkSize.z + 1) / g_chunkSize.z * g_chunkSize.z };
+}
+
+const Block* GameModule::findBlock(const World& world, const glm::ivec3& pos)
+{
+	if (pos.y < 0 || pos.y >= g_chunkSize.y)
+	{
+		return nullptr;
+	}
+
+	const glm::ivec3 chunkPos = getChunkOrigin(pos);
+	auto it = world.chunks.find(chunkPos);
+	if (it == world.chunks.end())
+	{
+		return nullptr;
+	}
+
+	const glm::ivec3 local = pos - chunkPos;
+	return &it->second.blocks[g_chunkSize.x * (g_chunkSize.z * local.y + local.z) + local.x];
+}
+
+int32_t GameModule::getSurfaceHeight(const World& world, int32_t x, int32_t z)
+{
+	const glm::ivec3 chunkPos = getChunkOrigin({ x, 0, z });
+	auto it = world.chunks.find(chunkPos);
+	if (it == world.chunks.end())
+	{
+		return -1;
+	}
+	return it->second.heights.surface[g_chunkSize.x * (z - chunkPos.z) + x - chunkPos.x];
+}
+
+bool GameModule::setBlock(World& world, const glm::ivec3& pos, Block block)
+{
+	if (pos.y < 0 || pos.y >= g_chunkSize.y)
+	{
+		return false;
+	}
+
+	const glm::ivec3 chunkPos = getChunkOrigin(pos);
+	auto it = world.chunks.find(chunkPos);
+	if (it == world.chunks.end())
+	{
+		return false;
+	}
+
+	Chunk& chunk = it->second;
+	const glm::ivec3 local = pos - chunkPos;
+	Block& current = chunk.blocks[g_chunkSize.x * (g_chunkSize.z * local.y + local.z) + local.x];
+
+	// The light belongs to the cell, only updateBlockLight changes it
+	setBlockLight(block, getBlockLight(current));
+	if (current.type == block.type && current.data == block.data)
+	{
+		return false;
+	}
+
+	const Block previous = current;
+	const bool typeChanged = current.type != block.type;
+	const bool solidityChanged = isSolidBlock(current.type) != isSolidBlock(block.type);
+	current = block;
+
+	// Blocks on the border have faces in the neighbour as well,
+	// so do the cells of their column the sun reaches from now on or no longer
+	if (typeChanged)
+	{
+		updateColumnHeights(chunk, local);
+
+		world.chunksToRemesh.insert(chunkPos);
+		if (local.x == 0) { world.chunksToRemesh.insert(chunk.left); }
+		if (local.x == g_chunkSize.x - 1) { world.chunksToRemesh.insert(chunk.right); }
+		if (local.z == 0) { world.chunksToRemesh.insert(chunk.back); }
+		if (local.z == g_chunkSize.z - 1) { world.chunksToRemesh.insert(chunk.front); }
 
-		if (world.chunks.find(chunk.front) != world.chunks.end())
+		updateBlockLight(world, pos, previous);
+	}
+
+	if (solidityChanged)
+	{
+		world.solidityChanged.insert(chunkPos);
+	}
+
+	// A falling block placed or the support of one taken away
+	const bool fallingAbove = local.y + 1 < g_chunkSize.y &&
+		isFallingBlock(chunk.blocks[g_chunkSize.x * (g_chunkSize.z * (local.y + 1) + local.z) + local.x].type);
+	if (isFallingBlock(block.type) || (!isSolidBlock(block.type) && fallingAbove))
+	{
+		queueColumn(world, pos);
+	}
+
+	activateFluids(world, pos);
+	return true;
+}
+
+// Chunks only write their own meshes and read the blocks of the neighbours, so they remesh in parallel
+void GameModule::remeshEditedChunks(World& world)
+{
+	static std::vector<Chunk*> chunks;
+
+	if (world.chunksToRemesh.empty())
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("remeshEditedChunks");
+
+	chunks.clear();
+	for (const glm::ivec3& pos : world.chunksToRemesh)
+	{
+		auto it = world.chunks.find(pos);
+		if (it != world.chunks.end())
 		{
-			updateChunkNeighbourFace(chunk, world.chunks[chunk.front]);
+			chunks.push_back(&it->second);
 		}
+	}
+	world.chunksToRemesh.clear();
 
-		if (world.chunks.find(chunk.back) != world.chunks.end())
+	Engine::parallelFor("remeshChunk", static_cast<uint32_t>(chunks.size()), 1, [&world](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
 		{
-			updateChunkNeighbourFace(chunk, world.chunks[chunk.back]);
+			remeshChunk(world, *chunks[i]);
 		}
+	});
 
-		if (world.chunks.find(chunk.right) != world.chunks.end())
+	for (Chunk* chunk : chunks)
+	{
+		chunk->casterOctant = g_invalidOctant;
+	}
+	world.transparentOrderDirty = true;
+}
+
+void GameModule::collectSolidityChanges(World& world, SolidityChanges& changes)
+{
+	for (const glm::ivec3& pos : world.solidityChanged)
+	{
+		auto it = world.chunks.find(pos);
+		if (it != world.chunks.end())
 		{
-			updateChunkNeighbourFace(chunk, world.chunks[chunk.right]);
+			changes.chunks.push_back(pos);
+			changes.masks.emplace_back();
+			buildSolidMask(changes.masks.back(), it->second);
 		}
+	}
+	world.solidityChanged.clear();
+}
 
-		if (world.chunks.find(chunk.left) != world.chunks.end())
+void GameModule::applySolidityChanges(World& world, SolidityChanges& changes)
+{
+	// Chunks unloaded in the meantime keep no mask
+	for (uint32_t i = 0; i < changes.chunks.size(); i++)
+	{
+		if (world.loaded.count(changes.chunks[i]))
 		{
-			updateChunkNeighbourFace(chunk, world.chunks[chunk.left]);
+			world.solidity[changes.chunks[i]] = changes.masks[i];
 		}
+	}
+	changes.chunks.clear();
+	changes.masks.clear();
+}
 
-		chunk.updated = false;
-		world.chunks.insert({ *world.chunksToAdd.begin(), chunk });
+void addChunk(World& world, Chunk& chunk)
+{
+	const glm::ivec3 chunkPos = glm::ivec3(chunk.pos);
 
-		for (auto& buffer : world.pool.buffers)
+	for (const glm::ivec3& pos : { chunk.front, chunk.back, chunk.right, chunk.left })
+	{
+		auto it = world.chunks.find(pos);
+		if (it != world.chunks.end())
 		{
-			if (!buffer.active)
+			// Border faces of a released neighbour come back with its remesh
+			if (it->second.meshReleased)
 			{
-				if (!world.chunks[*world.chunksToAdd.begin()].solidBuffer)
-				{
-					world.chunks[*world.chunksToAdd.begin()].solidBuffer = &buffer;
-					buffer.active = true;
-					world.pool.activeCounter++;
-				}
-				else if (!world.chunks[*world.chunksToAdd.begin()].transBuffer)
-				{
-					world.chunks[*world.chunksToAdd.begin()].transBuffer = &buffer;
-					buffer.active = true;
-					world.pool.activeCounter++;
-				}
-				else
-				{
-					break;
-				}
+				stitchChunkFaces(chunk, it->second);
 			}
-
-			if (world.pool.activeCounter == world.pool.buffers.size())
+			else
 			{
-				break;
+				updateChunkNeighbourFace(chunk, it->second);
 			}
+			it->second.casterOctant = g_invalidOctant;
 		}
+	}
 
-		world.chunksToAdd.erase(world.chunksToAdd.begin());
+	chunk.updated = false;
+	world.chunks[chunkPos] = std::move(chunk);
+	world.transparentOrderDirty = true;
+
+	Chunk& added = world.chunks[chunkPos];
+	acquireChunkBuffers(added, world.pool);
+
+	for (const glm::ivec3& pos : { added.front, added.back, added.right, added.left })
+	{
+		auto it = world.chunks.find(pos);
+		if (it != world.chunks.end() && it->second.meshReleased)
+		{
+			remeshChunk(world, it->second);
+		}
 	}
 }
 
-void GameModule::updateWorld(World& world, const Player& player, float dt)
+void GameModule::applyWorldChanges(World& world, WorldChanges& changes)
 {
+	PROFILE_SCOPE("applyWorldChanges");
+
+	// Buffers of removed chunks get reused once the GPU is done with them
+	for (const glm::ivec3& pos : changes.removed)
+	{
+		auto it = world.chunks.find(pos);
+		if (it != world.chunks.end())
+		{
+			disableChunk(it->second, world.pool);
+			world.chunks.erase(it);
+			world.fluids.erase(pos);
+			world.unsettled.erase(pos);
+			world.chunksToRemesh.erase(pos);
+			world.solidityChanged.erase(pos);
+			world.transparentOrderDirty = true;
+		}
+	}
+
+	for (Chunk& chunk : changes.added)
+	{
+		addChunk(world, chunk);
+	}
+
+	// The chunks that now have all their neighbours, they get remeshed with the edits
+	populateChunks(world);
+
+	changes.removed.clear();
+	changes.added.clear();
+}
+
+void GameModule::updateWorld(World& world, const Player& player, float dt, WorldChanges& changes)
+{
+	PROFILE_SCOPE("updateWorld");
+
 	// glm::mat4 model = glm::mat4(1.0f);
 	// model = glm::rotate(model, glm::radians(dt) * 10, glm::vec3(0.0f, 0.0f, 1.0f));
 	// world.lightDir = glm::normalize(glm::vec3(model * glm::vec4(world.lightDir, 1.0f)));
 
+	// Streaming stays off, world.pos doesn't follow the player yet. Once it does, chunks are
+	// generated here and handed over as changes, but their blocks stay with the render thread:
+	// block edits, fluids, falling blocks and remeshing run there, this thread only reads the solidity masks
 	return;
 
 	for (int32_t z = world.pos.z;
@@ -413,7 +685,7 @@ void GameModule::updateWorld(World& world, const Player& player, float dt)
 			x < world.pos.x + g_chunksX * g_chunkSize.x;
 			x += g_chunkSize.x)
 		{
-			if (world.chunks.find({ x, 0, z }) == world.chunks.end() &&
+			if (world.loaded.count({ x, 0, z }) == 0 &&
 				world.chunksToRemove.count({ x, 0, z }) == 0)
 			{
 				world.chunksToAdd.insert({ x, 0, z });
@@ -421,24 +693,33 @@ void GameModule::updateWorld(World& world, const Player& player, float dt)
 		}
 	}
 
-	for (const auto& pair : world.chunks)
+	for (const glm::ivec3& pos : world.loaded)
 	{
-		if (!isChunkInTerrain(world, pair.first))
+		if (!isChunkInTerrain(world, pos))
 		{
-			world.chunksToRemove.insert(pair.first);
+			world.chunksToRemove.insert(pos);
 		}
 	}
 
 	if (!world.chunksToRemove.empty())
 	{
-		world.pool.activeCounter -= disableChunk(world.chunks[*world.chunksToRemove.begin()]);
-		world.chunks.erase(*world.chunksToRemove.begin());
+		changes.removed.push_back(*world.chunksToRemove.begin());
+		world.loaded.erase(*world.chunksToRemove.begin());
+		world.solidity.erase(*world.chunksToRemove.begin());
 		world.chunksToRemove.erase(world.chunksToRemove.begin());
 	}
 
-	if (!world.chunksToAdd.empty() && world.pool.buffers.size() - world.pool.activeCounter >= 2)
+	// Generated and meshed here, the render thread only stitches it in
+	if (!world.chunksToAdd.empty())
 	{
-		addChunks(world);
+		const glm::ivec3 pos = *world.chunksToAdd.begin();
+		Chunk chunk = generateChunk(pos, world.terrain);
+		initChunkFaces(chunk);
+		buildSolidMask(world.solidity[pos], chunk);
+		changes.added.push_back(std::move(chunk));
+
+		world.loaded.insert(pos);
+		world.chunksToAdd.erase(world.chunksToAdd.begin());
 	}
 }
 
@@ -446,7 +727,7 @@ glm::mat4 getLightSpaceMatrix(const World& world, const Player& player,
 	const float nearPlane, const float farPlane,
 	const float prevSplitD, const float currSplitD)
 {
-	std::vector<glm::vec3> boundingVertices = {
+	std::array<glm::vec3, 8> boundingVertices = {
 		glm::vec3(-1.0f,  1.0f, -1.0f),
 		glm::vec3( 1.0f,  1.0f, -1.0f),
 		glm::vec3( 1.0f, -1.0f, -1.0f),
@@ -526,58 +807,146 @@ glm::mat4 getLightSpaceMatrix(const World& world, const Player& player,
 	return shadowProj * lightViewMatrix;
 }
 
-std::vector<glm::mat4> getLightSpaceMatrices(const World& world, const Player& player)
+// Nothing past the last split gets a cascade, the far terrain is shadowed by the skylight baked into its faces
+uint32_t getLightSpaceMatrices(const World& world, const Player& player, glm::mat4* ret)
 {
-	std::vector<glm::mat4> ret;
 	float prevSplitDistance = 0.1f;
 	float currSplitDistance;
-	for (size_t i = 0; i < world.shadowCascadeLevels.size() + 1; i++)
+	for (size_t i = 0; i < world.shadowCascadeLevels.size(); i++)
 	{
 		if (i == 0)
 		{
 			currSplitDistance = world.shadowCascadeLevels[i] - player.camera.nearPlane;
-			ret.push_back(getLightSpaceMatrix(world, player, 
-				player.camera.nearPlane, world.shadowCascadeLevels[i], prevSplitDistance, currSplitDistance));
+			ret[i] = getLightSpaceMatrix(world, player, 
+				player.camera.nearPlane, world.shadowCascadeLevels[i], prevSplitDistance, currSplitDistance);
 		}
-		else if (i < world.shadowCascadeLevels.size())
+		else
 		{
 			currSplitDistance = world.shadowCascadeLevels[i] - world.shadowCascadeLevels[i - 1];
-			ret.push_back(getLightSpaceMatrix(world, player, 
-				world.shadowCascadeLevels[i - 1], world.shadowCascadeLevels[i], prevSplitDistance, currSplitDistance));
+			ret[i] = getLightSpaceMatrix(world, player, 
+				world.shadowCascadeLevels[i - 1], world.shadowCascadeLevels[i], prevSplitDistance, currSplitDistance);
 		}
-		else
+
+		prevSplitDistance = currSplitDistance;
+	}
+	return world.shadowCascadeLevels.size();
+}
+
+// Once the GPU has a chunk, its CPU side meshes are only kept for what still gets rebuilt there
+void GameModule::releaseUploadedMeshes(World& world)
+{
+	for (auto& pair : world.chunks)
+	{
+		Chunk& chunk = pair.second;
+		if (chunk.updated && chunk.solidBuffer && !chunk.meshReleased)
 		{
-			currSplitDistance = player.camera.farPlane - world.shadowCascadeLevels[i - 1];
-			ret.push_back(getLightSpaceMatrix(world, player,
-				world.shadowCascadeLevels[i - 1], player.camera.farPlane, prevSplitDistance, currSplitDistance));
+			// Water faces still get sorted on the CPU
+			releaseChunkMeshes(chunk, world.sortWaterFaces);
 		}
 
-		prevSplitDistance = currSplitDistance;
+		if (chunk.casterUpdated && !chunk.casterMesh.empty())
+		{
+			Engine::Renderer::Mesh().swap(chunk.casterMesh);
+		}
+	}
+}
+
+// Meshes over the frame budget wait for the next frames,
+// but at least one chunk gets loaded every frame
+void loadChunkWithinBudget(World& world, Chunk& chunk)
+{
+	// Added while the pool was short, buffers may have been recycled since
+	if (!chunk.solidBuffer && !acquireChunkBuffers(chunk, world.pool))
+	{
+		return;
+	}
+
+	const size_t bytes = (chunk.solidMesh.size() + chunk.transparentMesh.size()) * sizeof(Engine::Renderer::Vertex);
+	if (bytes > world.uploadBudget && world.uploadBudget < g_frameUploadBudget)
+	{
+		return;
+	}
+
+	world.uploadBudget -= std::min(bytes, world.uploadBudget);
+	loadChunkMesh(chunk, world.commands);
+	chunk.updated = true;
+	world.transparentOrderDirty = true;
+}
+
+void updateChunkCaster(World& world, Chunk& chunk, uint8_t octant)
+{
+	if (chunk.casterOctant != octant)
+	{
+		// Border faces depend on the neighbours on the lit sides
+		const glm::ivec3& posX = world.lightDir.x > 0.0f ? chunk.right : chunk.left;
+		const glm::ivec3& posZ = world.lightDir.z > 0.0f ? chunk.front : chunk.back;
+
+		auto itX = world.chunks.find(posX);
+		auto itZ = world.chunks.find(posZ);
+
+		buildCasterMesh(chunk,
+			itX != world.chunks.end() ? &itX->second : nullptr,
+			itZ != world.chunks.end() ? &itZ->second : nullptr,
+			octant);
+	}
+
+	if (!chunk.casterUpdated)
+	{
+		loadCasterMesh(chunk, world.commands);
 	}
-	return ret;
 }
 
 void GameModule::drawWorlToSM(World& world, Player& player, Engine::Shader& shader)
 {
-	Engine::Renderer::updateUBufferLM(world.lightSpaceMatricesUBO, getLightSpaceMatrices(world, player));
+	using namespace Engine::Renderer;
+
+	PROFILE_SCOPE("drawWorlToSM");
+
+	CommandList& commands = world.commands;
+	beginCommands(commands);
 
-	Engine::bindFBuffer(world.shadowBuffer);
-	Engine::setFramebufferViewport();
-	Engine::clearDepthBuff();
-	Engine::Renderer::disableCulling();
+	world.lightSpaceMatrices = Engine::allocateFrame<glm::mat4>(world.frameArena, world.shadowCascadeLevels.size());
+	world.nLightSpaceMatrices = getLightSpaceMatrices(world, player, world.lightSpaceMatrices);
+	cmdUpdateUBuffer(commands, world.lightSpaceMatricesUBO,
+		world.lightSpaceMatrices, world.nLightSpaceMatrices * sizeof(glm::mat4));
 
+	const uint8_t octant = getLightOctant(world.lightDir);
 	for (auto& pair : world.chunks)
 	{
 		if (!pair.second.updated)
 		{
-			loadChunkMesh(pair.second);
-			pair.second.updated = true;
+			loadChunkWithinBudget(world, pair.second);
 		}
-		Engine::setUniform3f(shader, "u_chunkPos", pair.second.pos);
-		drawSolid(pair.second);
+		updateChunkCaster(world, pair.second, octant);
 	}
-	Engine::Renderer::enableCulling();
-	Engine::unbindFBuffer();
+	buildCascadeCasterLists(world, world.lightSpaceMatrices, world.nLightSpaceMatrices);
+
+	const int32_t layerLocation = Engine::getLocation(shader, Engine::Uniform::LAYER);
+	const int32_t posLocation = Engine::getLocation(shader, Engine::Uniform::CHUNK_POS);
+
+	cmdBindFramebuffer(commands, world.shadowBuffer.id);
+	cmdViewport(commands, Engine::g_shadowResolution, Engine::g_shadowResolution);
+	cmdCulling(commands, false);
+	cmdUseProgram(commands, shader.id);
+
+	// Each cascade layer is drawn separately with only the chunks overlapping it
+	for (uint32_t layer = 0; layer < world.cascadeCasters.size(); layer++)
+	{
+		cmdFramebufferLayer(commands, world.shadowBuffer.map, layer);
+		cmdClearDepth(commands);
+		cmdUniformi(commands, layerLocation, layer);
+
+		for (const Chunk* chunk : world.cascadeCasters[layer])
+		{
+			cmdUniform3f(commands, posLocation, chunk->pos);
+			drawCaster(*chunk, commands);
+		}
+	}
+	cmdCulling(commands, true);
+	cmdBindFramebuffer(commands, 0);
+
+	PROFILE_GPU_SCOPE("shadowPass");
+	submitCommands(commands);
 }
 
 #ifdef _DEBUG
@@ -588,46 +957,144 @@ void GameModule::drawDebugQuad(World& world, Engine::Shader& shader)
 }
 #endif
 
-void GameModule::drawWorld(World& world, const Player& player, Engine::Shader& shader)
+void GameModule::updateFrameData(World& world, const Player& player)
 {
-	Engine::useFArray(world.shadowBuffer);
-	std::lock_guard<std::mutex> lock(g_worldMutex);
-	std::multimap<float, glm::ivec3> sorted;
+	world.uploadBudget = g_frameUploadBudget;
+	Engine::Renderer::recycleBufferPool(world.pool);
 
+	Engine::Renderer::FrameData& frameData = world.frameData;
+	frameData.projection = player.camera.projection;
+	frameData.view = player.camera.view;
+	frameData.lightDir = glm::vec4(world.lightDir, 0.0f);
 	for (uint32_t i = 0; i < world.shadowCascadeLevels.size(); i++)
 	{
-		const std::string uniform = "u_cascadePlaneDistances[" + std::to_string(i) + "]";
-		Engine::setUniformf(shader, uniform.c_str(), world.shadowCascadeLevels[i]);
+		frameData.cascadePlaneDistances[i].x = world.shadowCascadeLevels[i];
+	}
+	frameData.farPlane = player.camera.farPlane;
+	frameData.cascadeCount = world.shadowCascadeLevels.size();
+
+	// Both passes of the frame draw what this finds
+	updateVisibility(world, player.camera.pos);
+
+	Engine::Renderer::beginCommands(world.commands);
+	Engine::Renderer::cmdUpdateUBuffer(world.commands, world.frameDataUBO, &frameData, sizeof(frameData));
+	Engine::Renderer::submitCommands(world.commands);
+}
+
+void updateTransparentOrder(World& world, const Player& player)
+{
+	if (world.transparentOrderDirty)
+	{
+		world.transparentOrder.clear();
+		for (auto& pair : world.chunks)
+		{
+			if (pair.second.transVertices > 0)
+			{
+				world.transparentOrder.push_back({ 0.0f, &pair.second });
+			}
+		}
+		world.transparentOrderDirty = false;
+	}
+
+	for (auto& entry : world.transparentOrder)
+	{
+		const glm::vec2 center = {
+			entry.chunk->pos.x + g_chunkSize.x / 2.0f,
+			entry.chunk->pos.z + g_chunkSize.z / 2.0f };
+		const glm::vec2 toChunk = center - glm::vec2(player.camera.pos.x, player.camera.pos.z);
+		entry.distance = glm::dot(toChunk, toChunk);
 	}
 
-	Engine::setUniform3f(shader, "u_lightDir", world.lightDir);
-	Engine::setUniformf(shader, "u_farPlane", player.camera.farPlane);
-	Engine::setUniformi(shader, "u_cascadeCount", world.shadowCascadeLevels.size());
+	// Order barely changes between frames, so insertion sort is close to linear
+	auto& order = world.transparentOrder;
+	for (size_t i = 1; i < order.size(); i++)
+	{
+		const TransparentChunk entry = order[i];
+		size_t j = i;
+		for (; j > 0 && order[j - 1].distance < entry.distance; j--)
+		{
+			order[j] = order[j - 1];
+		}
+		order[j] = entry;
+	}
+}
+
+void sortWaterFaces(World& world, const Player& player, Engine::Renderer::CommandList& commands)
+{
+	const glm::ivec3 cameraBlock = glm::floor(player.camera.pos);
+	if (!world.sortWaterFaces || cameraBlock == world.lastCameraBlock)
+	{
+		return;
+	}
+	world.lastCameraBlock = cameraBlock;
+
+	for (auto& entry : world.transparentOrder)
+	{
+		if (entry.distance < g_waterSortDistance * g_waterSortDistance && entry.chunk->transBuffer)
+		{
+			if (entry.chunk->transparentMesh.empty())
+			{
+				// Released while sorting was off
+				remeshChunk(world, *entry.chunk);
+			}
+			sortTransparentFaces(*entry.chunk, player.camera.pos);
+			Engine::Renderer::cmdUpload(commands, *entry.chunk->transBuffer, entry.chunk->transparentMesh);
+		}
+	}
+}
+
+void GameModule::drawWorld(World& world, const Player& player, Engine::Shader& shader)
+{
+	using namespace Engine::Renderer;
+
+	PROFILE_SCOPE("drawWorld");
+
+	CommandList& commands = world.commands;
+	beginCommands(commands);
+
+	const int32_t posLocation = Engine::getLocation(shader, Engine::Uniform::CHUNK_POS);
+
+	cmdUseProgram(commands, shader.id);
+	cmdBindTextureArray(commands, 1, world.shadowBuffer.map);
+
 	for (auto& pair : world.chunks)
 	{
 		if (!pair.second.updated)
 		{
-			loadChunkMesh(pair.second);
-			pair.second.updated = true;
+			loadChunkWithinBudget(world, pair.second);
 		}
-		Engine::setUniform3f(shader, "u_chunkPos", pair.second.pos);
-		drawSolid(pair.second);
+		if (pair.second.visibleSections)
+		{
+			cmdUniform3f(commands, posLocation, pair.second.pos);
+			drawSolid(pair.second, commands);
+		}
+	}
 
-		if (!pair.second.transparentMesh.empty())
+	updateTransparentOrder(world, player);
+	sortWaterFaces(world, player, commands);
+
+	cmdCulling(commands, false);
+	for (const auto& entry : world.transparentOrder)
+	{
+		if (!entry.chunk->visibleSections)
 		{
-			float distance = glm::length(player.camera.pos - static_cast<const glm::vec3>(pair.first));
-			sorted.insert({ distance, pair.first });
+			continue;
 		}
+		cmdUniform3f(commands, posLocation, entry.chunk->pos);
+		drawTrans(*entry.chunk, commands);
 	}
+	cmdCulling(commands, true);
 
+	PROFILE_GPU_SCOPE("worldPass");
+	submitCommands(commands);
 
-	Engine::Renderer::disableCulling();
-	for (auto it = sorted.rbegin(); it != sorted.rend(); it++)
+	if (world.releaseMeshes)
 	{
-		Engine::setUniform3f(shader, "u_chunkPos", it->second);
-		drawTrans(world.chunks[it->second]);
+		releaseUploadedMeshes(world);
 	}
-	Engine::Renderer::enableCulling();
+
+	// Released buffers can be reused once the GPU is done with this frame
+	fenceBufferPool(world.pool);
 }
 
 bool collAABB(const Player& player, const glm::vec3& pos)
@@ -773,217 +1240,3 @@ void GameModule::traceRay(World& world, glm::vec3 rayPosFrac, Engine::Shader& sh
 	}
 	*/
 }
-
-bool sweptAABB(const Player& player, const Block& block, glm::vec3& normals, float dt, float& hitTime)
-{
-	float dxEntry, dzEntry, dyEntry;
-	float dxExit, dzExit, dyExit;
-
-	glm::vec3 vel = glm::normalize(player.velocity) * dt;
-	/*
-	if (player.velocity.x > 0.0f)
-	{
-		dxEntry = block.pos.x - (player.pos.x + player.size.x);
-		dxExit = block.pos.x + 1.0f - player.pos.x;
-	}
-	else
-	{
-		dxEntry = block.pos.x + 1.0f - player.pos.x;
-		dxExit = block.pos.x - (player.pos.x + player.size.x);
-	}
-
-	if (player.velocity.z > 0.0f)
-	{
-		dzEntry = block.pos.z - (player.pos.z + player.size.z);
-		dzExit = block.pos.z + 1.0f - player.pos.z;
-	}
-	else
-	{
-		dzEntry = block.pos.z + 1.0f - player.pos.z;
-		dzExit = block.pos.z - (player.pos.z + player.size.z);
-	}
-
-	if (player.velocity.y > 0.0f)
-	{
-		dyEntry = block.pos.y - (player.pos.y + player.size.y);
-		dyExit = block.pos.y + 1.0f - player.pos.y;
-	}
-	else
-	{
-		dyEntry = block.pos.y + 1.0f - player.pos.y;
-		dyExit = block.pos.y - (player.pos.y + player.size.y);
-	}
-
-	float txEntry, tzEntry, tyEntry;
-	float txExit, tzExit, tyExit;
-
-	if (player.velocity.x == 0.0f)
-	{
-		txEntry = -std::numeric_limits<float>::infinity();
-		txExit = std::numeric_limits<float>::infinity();
-	}
-	else
-	{
-		txEntry = dxEntry / vel.x;
-		txExit = dxExit / vel.x;
-	}
-
-	if (player.velocity.z == 0.0f)
-	{
-		tzEntry = -std::numeric_limits<float>::infinity();
-		tzExit = std::numeric_limits<float>::infinity();
-	}
-	else
-	{
-		tzEntry = dzEntry / vel.z;
-		tzExit = dzExit / vel.z;
-	}
-
-	if (player.velocity.y == 0.0f)
-	{
-		tyEntry = -std::numeric_limits<float>::infinity();
-		tyExit = std::numeric_limits<float>::infinity();
-	}
-	else
-	{
-		tyEntry = dyEntry / vel.y;
-		tyExit = dyExit / vel.y;
-	}
-
-	hitTime = std::max(std::max(txEntry, tzEntry), tyEntry);
-	float exitTime = std::min(std::min(txExit, tzExit), tyExit);
-
-	if (block.type == BlockType::AIR ||
-		hitTime > exitTime ||
-		(txEntry < 0.0f && tzEntry < 0.0f && tyEntry < 0.0f)
-		|| txEntry > 1.0f || tzEntry > 1.0f || tyEntry > 1.0f)
-	{
-		return false;
-	}
-
-	if (txEntry > tyEntry)
-	{
-		if (txEntry > tzEntry)
-		{
-			if (player.velocity.x < 0.0f)
-			{
-				normals = { 1, 0, 0 };
-			}
-			else
-			{
-				normals = { -1, 0, 0 };
-			}
-		}
-		else
-		{
-			if (player.velocity.z < 0.0f)
-			{
-				normals = { 0, 0, 1 };
-			}
-			else
-			{
-				normals = { 0, 0, -1 };
-			}
-		}
-	}
-	else
-	{
-		if (tyEntry > tzEntry)
-		{
-			if (player.velocity.y < 0.0f)
-			{
-				normals = { 0, 1, 0 };
-			}
-			else
-			{
-				normals = { 0, -1, 0 };
-			}
-		}
-		else
-		{
-			if (player.velocity.z < 0.0f)
-			{
-				normals = { 0, 0, 1 };
-			}
-			else
-			{
-				normals = { 0, 0, -1 };
-			}
-		}
-	}
-	*/
-	return true;
-}
-
-void GameModule::checkPlayerCollision(World& world, Player& player, float dt)
-{
-	float x = player.velocity.x > 0.0f ? 1 : -1;
-	float z = player.velocity.z > 0.0f ? 1 : -1;
-	float y = player.velocity.y > 0.0f ? 3 : -1;
-
-	const glm::vec3 start = { player.pos.x, player.pos.y, player.pos.z };
-
-	const Block& leftZ = getBlock(world, { start.x,	start.y, start.z + z });
-	const Block& rightZ = getBlock(world, { start.x + 1.0f,	start.y, start.z + z });
-	const Block& backX = getBlock(world, { start.x + x,	start.y, start.z });
-	const Block& frontX = getBlock(world, { start.x + x, start.y, start.z + 1.0f });
-	const Block& leftFZ = getBlock(world, { start.x, start.y + 1.0f, start.z + z });
-	const Block& rightFZ = getBlock(world, { start.x + 1.0f, start.y + 1.0f, start.z + z });
-	const Block& backFX = getBlock(world, { start.x + x, start.y + 1.0f, start.z });
-	const Block& frontFX = getBlock(world, { start.x + x, start.y + 1.0f, start.z + 1.0f });
-	const Block& frontLY = getBlock(world, { start.x, start.y + y, start.z + 1.0f });
-	const Block& frontRY = getBlock(world, { start.x + 1.0f, start.y + y, start.z + 1.0f });
-	const Block& backLY = getBlock(world, { start.x, start.y + y, start.z });
-	const Block& backRY = getBlock(world, { start.x + 1.0f,	start.y + y, start.z });
-
-	glm::vec3 normals = glm::vec3(0);
-
-	float t;
-
-	std::vector<std::pair<float, const Block*>> distances;
-	if (sweptAABB(player, leftZ, normals, dt, t)) { distances.push_back({ t, &leftZ }); }
-	if (sweptAABB(player, rightZ, normals, dt, t)) { distances.push_back({ t, &rightZ }); }
-	if (sweptAABB(player, backX, normals, dt, t)) { distances.push_back({ t, &backX }); }
-	if (sweptAABB(player, frontX, normals, dt, t)) { distances.push_back({ t, &frontX }); }
-	if (sweptAABB(player, leftFZ, normals, dt, t)) { distances.push_back({ t, &leftFZ }); }
-	if (sweptAABB(player, rightFZ, normals, dt, t)) { distances.push_back({ t, &rightFZ }); }
-	if (sweptAABB(player, backFX, normals, dt, t)) { distances.push_back({ t, &backFX }); }
-	if (sweptAABB(player, frontFX, normals, dt, t)) { distances.push_back({ t, &frontFX }); }
-	if (sweptAABB(player, frontLY, normals, dt, t)) { distances.push_back({ t, &frontLY }); }
-	if (sweptAABB(player, frontRY, normals, dt, t)) { distances.push_back({ t, &frontRY }); }
-	if (sweptAABB(player, backLY, normals, dt, t)) { distances.push_back({ t, &backLY }); }
-	if (sweptAABB(player, backRY, normals, dt, t)) { distances.push_back({ t, &backRY }); }
-
-	std::sort(distances.begin(), distances.end(),
-		[](const std::pair<float, const Block*>& a, const std::pair<float, const Block*>& b) {
-			return a.first < b.first;
-		});
-
-	for (auto& pair : distances)
-	{
-		glm::vec3 absoluteVelocity = { std::abs(player.velocity.x), std::abs(player.velocity.y), std::abs(player.velocity.z) };
-		glm::vec3 normals = glm::vec3(0);
-		float t;
-		if (sweptAABB(player, *pair.second, normals, dt, t))
-		{
-			player.velocity += normals * absoluteVelocity * (1 - t);
-		}
-	}
-}
-
-bool GameModule::isPlayerFalling(World& world, const Player& player, float dt)
-{
-	const glm::vec3 start = { player.pos.x, player.pos.y, player.pos.z };
-
-	const Block& frontLY = getBlock(world, { start.x,				start.y - 1.0f,	start.z + 1.0f });
-	const Block& frontRY = getBlock(world, { start.x + 1.0f,		start.y - 1.0f,	start.z + 1.0f });
-	const Block& backLY = getBlock(world, { start.x,				start.y - 1.0f,	start.z });
-	const Block& backRY = getBlock(world, { start.x + 1.0f,		start.y - 1.0f,	start.z });
-
-	glm::vec3 normals;
-	float t;
-
-	return
-		!sweptAABB(player, frontLY, normals, dt, t) && !sweptAABB(player, frontRY, normals, dt, t) &&
-		!sweptAABB(player, backLY, normals, dt, t) && !sweptAABB(player, backRY, normals, dt, t);
-}
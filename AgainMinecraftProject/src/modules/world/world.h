@@ -4,11 +4,19 @@
 #include <unordered_set>
 #include <queue>
 #include <set>
+#include <limits>
 
 #include <glm/glm.hpp>
 
 #include "../../engine/renderer/mesh.h"
+#include "../../engine/renderer/commands.h"
+#include "../../engine/renderer/staging.h"
 #include "../../engine/texture/framebuffer.h"
+#include "../../engine/memory/frame_arena.h"
+
+#include "collision.h"
+#include "fluid.h"
+#include "falling.h"
 
 namespace Engine
 {
@@ -16,12 +24,6 @@ namespace Engine
 	struct Shader;
 	struct FBuffer;
 
-	namespace Renderer
-	{
-		template <uint32_t N>
-		struct BufferPool;
-	}
-
 	void enableCulling();
 	void disableCulling();
 }
@@ -37,6 +39,26 @@ namespace GameModule
 	struct Block;
 	struct Player;
 
+	// Made by the simulation thread, applied by the render thread before it draws
+	struct WorldChanges
+	{
+		std::vector<Chunk>		added; // Generated and meshed, stitched when applied
+		std::vector<glm::ivec3>	removed;
+	};
+
+	// Masks rebuilt by the render thread after block edits, taken over by the simulation thread
+	struct SolidityChanges
+	{
+		std::vector<glm::ivec3>	chunks;
+		std::vector<SolidMask>	masks;
+	};
+
+	struct TransparentChunk
+	{
+		float	distance; // Squared, from the camera
+		Chunk*	chunk;
+	};
+
 	struct World
 	{
 		glm::ivec3 pos;
@@ -45,6 +67,8 @@ namespace GameModule
 		glm::vec3 lightDir = glm::normalize(glm::vec3(40.0f, 25.0f, 0.0f));
 
 		float updateRadius;
+
+		TerrainMode terrain = TerrainMode::DENSITY;
 		
 		struct KeyFuncs
 		{
@@ -63,12 +87,25 @@ namespace GameModule
 			}
 		};
 
+		// Only touched by the render thread once the world is initialized
 		std::unordered_map<glm::ivec3, Chunk, KeyFuncs> chunks;
 
-		Engine::Renderer::BufferPool<2 * g_chunksX * g_chunksZ> pool; // We need for every chunk 2 meshes
+		Engine::Renderer::BufferPool pool; // We need for every chunk 3 meshes
 
+		// Block edits of the render thread, remeshed together once per frame
+		std::unordered_set<glm::ivec3, KeyFuncs> chunksToRemesh;
+		std::unordered_set<glm::ivec3, KeyFuncs> solidityChanged;
+
+		std::unordered_map<glm::ivec3, FluidChunk, KeyFuncs> fluids;
+		float fluidTime = 0.0f;
+
+		std::unordered_map<glm::ivec3, ColumnSet, KeyFuncs> unsettled;
+
+		// Streaming state of the simulation thread, loaded mirrors the keys of chunks
+		std::unordered_set<glm::ivec3, KeyFuncs> loaded;
 		std::unordered_set<glm::ivec3, KeyFuncs> chunksToRemove;
 		std::unordered_set<glm::ivec3, KeyFuncs> chunksToAdd;
+		std::unordered_map<glm::ivec3, SolidMask, KeyFuncs> solidity;
 
 		uint32_t threadsAvailable;
 
@@ -76,12 +113,75 @@ namespace GameModule
 
 		Engine::FBuffer shadowBuffer;
 		Engine::Renderer::UBuffer lightSpaceMatricesUBO;
+		Engine::Renderer::UBuffer frameDataUBO;
+		Engine::Renderer::FrameData frameData;
+
+		// Transient per-frame data, reset at the start of every frame
+		Engine::FrameArena frameArena;
+
+		// Frame arena allocated, the UBO upload reads it on submit
+		glm::mat4* lightSpaceMatrices = nullptr;
+		uint32_t nLightSpaceMatrices = 0;
+
+		Engine::Renderer::CommandList commands;
+
+		// Drop CPU meshes once they are uploaded, chunks get remeshed from their blocks
+		bool releaseMeshes = true;
+
+		// Chunk meshes go through the staging ring, limited per frame
+		Engine::Renderer::UploadManager uploads;
+		size_t uploadBudget = 0;
+
+		std::vector<std::vector<Chunk*>> cascadeCasters; // Chunks overlapping each cascade
+
+		// Kept between frames, so it is already almost sorted back to front
+		std::vector<TransparentChunk> transparentOrder;
+		bool transparentOrderDirty = true;
+
+		// Water faces of close chunks get sorted when the camera moves to another block
+		bool sortWaterFaces = true;
+
+		// Chunks the camera can't see into through the open sections are skipped
+		bool cullOccluded = true;
+		glm::ivec3 lastCameraBlock = glm::ivec3(std::numeric_limits<int32_t>::max());
+	};
+
+	// Byte counts of what the world keeps in RAM and on the GPU
+	struct WorldMemory
+	{
+		uint32_t	chunks;
+		size_t		blockBytes;
+		size_t		meshBytes;		// CPU side copies of the solid, transparent and caster meshes
+		size_t		meshSlackBytes;	// Capacity the meshes keep but don't use
+		size_t		gpuMeshBytes;	// Vertex storage of the pool buffers
+		size_t		gpuBytes;		// Every GL buffer allocated through the renderer
+		uint32_t	activeBuffers;
+		uint32_t	poolSize;
 	};
 
 	void initWorld(World& world, const Player& player);
+	void initWorldChunks(World& world); // Uploads go through world.commands, so it runs with the mock backend too
 	void initChunkFaces(Chunk& chunk);
-	void updateWorld(World& world, const Player& player, float dt);
+	void updateWorld(World& world, const Player& player, float dt, WorldChanges& changes);
+	void applyWorldChanges(World& world, WorldChanges& changes);
+
+	glm::ivec3 getChunkOrigin(const glm::ivec3& pos);
 
+	// Render thread, nullptr when the chunk isn't loaded
+	const Block* findBlock(const World& world, const glm::ivec3& pos);
+	// Render thread, right above the highest block that isn't air, -1 when the chunk isn't loaded
+	int32_t getSurfaceHeight(const World& world, int32_t x, int32_t z);
+	// Render thread, queues the remesh, the solidity update, falling blocks and the water around the block
+	bool setBlock(World& world, const glm::ivec3& pos, Block block);
+	void remeshEditedChunks(World& world);
+
+	void collectSolidityChanges(World& world, SolidityChanges& changes);
+	void applySolidityChanges(World& world, SolidityChanges& changes);
+
+	WorldMemory getWorldMemory(World& world);
+	void releaseUploadedMeshes(World& world);
+
+	void updateFrameData(World& world, const Player& player);
 	void drawWorld(World& world, const Player& player, Engine::Shader& shader);
 	void drawWorlToSM(World& world, Player& player, Engine::Shader& shader);
 #ifdef _DEBUG
@@ -90,8 +190,4 @@ namespace GameModule
 
 	void processRay(World& world, const Player& player, Engine::Ray& ray, Engine::Shader& shader, RayType type);
 	void traceRay(World& world, glm::vec3 rayPosFrac, Engine::Shader& shader, RayType type);
-	
-	void checkPlayerCollision(World& world, Player& player, float dt);
-
-	bool isPlayerFalling(World& world, const Player& player, float dt);
 }